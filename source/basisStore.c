@@ -0,0 +1,198 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#include "basisStore.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "booleanMatrix.h"
+#include "memoryManagement.h"
+#include "menu.h"
+#include "settings.h"
+
+#define BASIS_STORE_MAGIC   "VCBASIS"
+#define BASIS_STORE_VERSION 1
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME        0x100000001b3ULL
+
+// Global
+char *basisStorePath = NULL;
+
+/*  The store file of (n, k) holds this header, followed by the m column masks of B0
+    and the m column masks of B1 as 32-bit integers in the byte order of the machine.
+*/
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t n;
+    uint32_t k;
+    uint32_t m;
+    uint64_t checksum;  // FNV-1a of the column masks
+} BasisStoreHeader;
+
+/*********************************************************************
+ * Function:     calcChecksum
+ *--------------------------------------------------------------------
+ * Description:  Continue the 64 bit FNV-1a hash "hash" over "size"
+ *               bytes. A new hash starts with FNV_OFFSET_BASIS.
+ ********************************************************************/
+static uint64_t calcChecksum(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/*********************************************************************
+ * Function:     createStoreFilePath
+ *--------------------------------------------------------------------
+ * Description:  Return the path of the store file for (n, k), like
+ *               "<basisStorePath>/basis_n08_k08.bin".
+ ********************************************************************/
+static char *createStoreFilePath(int n, int k) {
+    size_t pathLen = strlen(basisStorePath) + 24;
+    char *path = xcalloc(pathLen, 1);
+    snprintf(path, pathLen, "%s/basis_n%02d_k%02d.bin", basisStorePath, n, k);
+    return path;
+}
+
+/*********************************************************************
+ * Function:     mapStoreFile
+ *--------------------------------------------------------------------
+ * Description:  Map the store file at "path" and check its header.
+ * Return:       1 if "basis" points to the mapped masks, 0 if the file
+ *               is missing or doesn't match.
+ ********************************************************************/
+static int mapStoreFile(const char *path, BasisMatrices *basis) {
+    size_t masksSize = 2 * (size_t)basis->m * sizeof(int32_t);
+    size_t size = sizeof(BasisStoreHeader) + masksSize;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) || (size_t)fileStat.st_size != size) {
+        close(fd);
+        return 0;
+    }
+
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return 0;
+    }
+
+    const BasisStoreHeader *header = mapping;
+    const int32_t *masks = (const int32_t *)(header + 1);
+    if (memcmp(header->magic, BASIS_STORE_MAGIC, sizeof(header->magic)) || header->version != BASIS_STORE_VERSION ||
+        header->n != (uint32_t)basis->n || header->k != (uint32_t)basis->k || header->m != (uint32_t)basis->m ||
+        header->checksum != calcChecksum(FNV_OFFSET_BASIS, masks, masksSize)) {
+        munmap(mapping, size);
+        return 0;
+    }
+
+    basis->B0 = masks;
+    basis->B1 = masks + basis->m;
+    basis->mapping = mapping;
+    basis->mappingSize = size;
+    return 1;
+}
+
+/*********************************************************************
+ * Function:     writeStoreFile
+ *--------------------------------------------------------------------
+ * Description:  Write the masks of "basis" to the store file at
+ *               "path". The file is written under a temporary name
+ *               and renamed afterwards, so a concurrently running
+ *               program never maps a partly written file.
+ * Return:       1 on success, 0 on failure.
+ ********************************************************************/
+static int writeStoreFile(const char *path, BasisMatrices *basis) {
+    size_t masksSize = (size_t)basis->m * sizeof(int32_t);
+    BasisStoreHeader header = {.magic = BASIS_STORE_MAGIC,
+                               .version = BASIS_STORE_VERSION,
+                               .n = basis->n,
+                               .k = basis->k,
+                               .m = basis->m};
+    header.checksum = calcChecksum(calcChecksum(FNV_OFFSET_BASIS, basis->B0, masksSize), basis->B1, masksSize);
+
+    mkdir(basisStorePath, 0755);  // may already exist
+
+    size_t tmpPathLen = strlen(path) + 16;
+    char *tmpPath = xcalloc(tmpPathLen, 1);
+    snprintf(tmpPath, tmpPathLen, "%s.%ld", path, (long)getpid());
+
+    int success = 0;
+    FILE *file = fopen(tmpPath, "wb");
+    if (file) {
+        success = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(basis->B0, masksSize, 1, file) == 1 &&
+                  fwrite(basis->B1, masksSize, 1, file) == 1;
+        success = !fclose(file) && success && !rename(tmpPath, path);
+        if (!success) {
+            remove(tmpPath);
+        }
+    }
+
+    xfree(tmpPath);
+    return success;
+}
+
+/*********************************************************************
+ * Function:     printBasisMatrices
+ *--------------------------------------------------------------------
+ * Description:  Print the basis matrices B0 and B1 row by row.
+ ********************************************************************/
+static void printBasisMatrices(BasisMatrices *basis) {
+    const int *matrices[2] = {basis->B0, basis->B1};
+
+    for (int idx = 0; idx < 2; idx++) {
+        fprintf(stdout, "B%d:\n", idx);
+        for (int i = 0; i < basis->n; i++) {
+            for (int j = 0; j < basis->m; j++) {
+                fprintf(stdout, "%d", matrices[idx][j] >> i & 1);
+            }
+            fprintf(stdout, "\n");
+        }
+        fprintf(stdout, "\n");
+    }
+}
+
+BasisMatrices loadBasisMatrices(int n, int k) {
+    BasisMatrices basis = {.n = n, .k = k, .m = 1 << (n - 1), .mapping = NULL, .mappingSize = 0};
+    char *path = createStoreFilePath(n, k);
+
+    if (mapStoreFile(path, &basis)) {
+        printVerbose("basis matrices: mapped from %s\n", path);
+    } else {
+        int *masks = xmalloc(2 * (size_t)basis.m * sizeof(int));
+        fillBasisColumnMasks(masks, masks + basis.m, n);
+        basis.B0 = masks;
+        basis.B1 = masks + basis.m;
+
+        if (writeStoreFile(path, &basis)) {
+            printVerbose("basis matrices: calculated and stored in %s\n", path);
+        } else {
+            printVerbose("basis matrices: calculated, can't store them in %s\n", path);
+        }
+    }
+
+    if (PRINT_BASIS_MATRICES) {
+        printBasisMatrices(&basis);
+    }
+
+    xfree(path);
+    return basis;
+}
@@ -0,0 +1,39 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#ifndef BASISSTORE_H
+#define BASISSTORE_H
+
+#include <stddef.h>
+
+extern char *basisStorePath;
+
+typedef struct {
+    int n;               // number of shares = rows of the basis matrices
+    int k;               // number of shares needed to decrypt
+    int m;               // number of columns = 2^(n-1)
+    const int *B0;       // column masks of the basis matrix for white pixel
+    const int *B1;       // column masks of the basis matrix for black pixel
+    void *mapping;       // mapped store file, or NULL if the masks are allocated
+    size_t mappingSize;  // size of "mapping" in bytes
+} BasisMatrices;
+
+/*********************************************************************
+ * Function:     loadBasisMatrices
+ *--------------------------------------------------------------------
+ * Description:  Return the column masks of the basis matrices for
+ *               "n" shares, of which "k" are needed to decrypt.
+ *               They are mapped read-only from the file of (n, k) in
+ *               the directory "basisStorePath", so repeated program
+ *               runs don't calculate them again and share the pages.
+ *               If the file is missing or its header doesn't match
+ *               (magic, version, n, k, m or the checksum of the
+ *               masks), the masks are calculated with
+ *               fillBasisColumnMasks() and the file is (re)written.
+ *               If that fails, the calculated masks are used anyway.
+ ********************************************************************/
+BasisMatrices loadBasisMatrices(int n, int k);
+
+#endif /* BASISSTORE_H */
@@ -0,0 +1,131 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#ifndef BIT_TRANSPOSE_H
+#define BIT_TRANSPOSE_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*  The algorithms calculate a vector of n bits per pixel, one bit per share (pixel-major), but
+    the shares are stored as n separate bit-packed rows (plane-major). The functions below turn
+    the vectors of a row into the planes. They are inlined, so callers with a constant number of
+    planes get the loops unrolled.
+*/
+
+/*********************************************************************
+ * Function:     transposeBits8x8
+ *--------------------------------------------------------------------
+ * Description:  Transpose a matrix of 8x8 bits, where bit "j" of byte
+ *               "i" is the element of row "i" and column "j", by
+ *               swapping 1x1, 2x2 and then 4x4 blocks.
+ ********************************************************************/
+static inline uint64_t transposeBits8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+/*********************************************************************
+ * Function:     transposeBytes8
+ *--------------------------------------------------------------------
+ * Description:  OR the planes firstPlane to firstPlane+7 of the (up to)
+ *               8 vectors vectors[0] to vectors[count-1] into bit
+ *               "shift" to "shift+count-1" of the words "planes".
+ ********************************************************************/
+static inline void transposeBytes8(uint64_t *planes, const int *vectors, int count, int firstPlane, int shift) {
+    uint64_t block = 0;
+    if (count == 8) {  // constant loop count, so it's unrolled
+        for (int c = 0; c < 8; c++) {
+            block |= (uint64_t)((vectors[c] >> firstPlane) & 0xFF) << (8 * c);
+        }
+    } else {
+        for (int c = 0; c < count; c++) {
+            block |= (uint64_t)((vectors[c] >> firstPlane) & 0xFF) << (8 * c);
+        }
+    }
+    block = transposeBits8x8(block);
+
+    for (int r = 0; r < 8; r++) {
+        planes[r] |= ((block >> (8 * r)) & 0xFF) << shift;
+    }
+}
+
+#if defined(__SSE2__)
+/*********************************************************************
+ * Function:     transposeBytes16
+ *--------------------------------------------------------------------
+ * Description:  Same as transposeBytes8() for 16 vectors, but only for
+ *               the first "numPlanes" planes. The byte "firstPlane/8"
+ *               of the vectors is packed into a SSE2 register, whose
+ *               bit "r" of all 16 bytes is extracted at once by
+ *               shifting it to the top bit and _mm_movemask_epi8().
+ ********************************************************************/
+static inline void transposeBytes16(uint64_t *planes, const int *vectors, int numPlanes, int firstPlane, int shift) {
+    __m128i count = _mm_cvtsi32_si128(firstPlane);
+    __m128i lowByte = _mm_set1_epi32(0xFF);
+    __m128i v0 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i *)vectors), count), lowByte);
+    __m128i v1 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i *)(vectors + 4)), count), lowByte);
+    __m128i v2 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i *)(vectors + 8)), count), lowByte);
+    __m128i v3 = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128((const __m128i *)(vectors + 12)), count), lowByte);
+    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+
+    // shifting the 64 bit lanes moves bit "r" of each byte to bit 7 of the same byte, as long as r <= 7
+    for (int r = 0; r < numPlanes; r++) {
+        planes[r] |= (uint64_t)(_mm_movemask_epi8(_mm_slli_epi64(bytes, 7 - r)) & 0xFFFF) << shift;
+    }
+}
+#endif
+
+/*********************************************************************
+ * Function:     transposeVectorsToPlanes
+ *--------------------------------------------------------------------
+ * Description:  Write bit "i" of the vectors vectors[0] to
+ *               vectors[count-1] to the bits 0 to count-1 of plane
+ *               "i", for the "numPlanes" (up to 31) planes. Plane "i"
+ *               starts at planes[i * planeStride]. The bits behind
+ *               "count" are set to zero.
+ *               With SSE2, 16 vectors are turned into 16 bits of each
+ *               plane at once, otherwise 8 by a transposition of 8x8
+ *               bits.
+ ********************************************************************/
+static inline void transposeVectorsToPlanes(uint64_t *planes, int planeStride, const int *vectors, int count,
+                                            int numPlanes) {
+    // for each 8 planes, which are byte "firstPlane / 8" of the vectors
+    for (int firstPlane = 0; firstPlane < numPlanes; firstPlane += 8) {
+        int blockPlanes = numPlanes - firstPlane < 8 ? numPlanes - firstPlane : 8;
+
+        // for each word of the planes
+        for (int word = 0; word * 64 < count; word++) {
+            int first = word * 64;
+            int last = count < first + 64 ? count : first + 64;
+            uint64_t rows[8] = {0};
+
+            int j = first;
+#if defined(__SSE2__)
+            for (; last - j >= 16; j += 16) {
+                transposeBytes16(rows, vectors + j, blockPlanes, firstPlane, j - first);
+            }
+#endif
+            for (; j < last; j += 8) {
+                transposeBytes8(rows, vectors + j, last - j < 8 ? last - j : 8, firstPlane, j - first);
+            }
+
+            for (int r = 0; r < blockPlanes; r++) {
+                planes[(firstPlane + r) * planeStride + word] = rows[r];
+            }
+        }
+    }
+}
+
+#endif /* BIT_TRANSPOSE_H */
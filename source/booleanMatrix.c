@@ -5,64 +5,56 @@
 
 #include "booleanMatrix.h"
 
-#include <stdio.h>
 #include <time.h>
 
 #include "memoryManagement.h"
-#include "settings.h"
 
 BooleanMatrix createBooleanMatrix(int height, int width) {
     BooleanMatrix result;
     result.height = height;
     result.width = width;
-    result.array = xmalloc(sizeof(Pixel) * height * width);
+    result.stride = (width + 63) / 64;
+    result.words = xcalloc((size_t)height * result.stride, sizeof(uint64_t));
     return result;
 }
 
 void deleteBooleanMatrix(BooleanMatrix *matrix) {
-    xfree(matrix->array);
+    xfree(matrix->words);
 }
 
-void fillBasisMatrix(BooleanMatrix *B, SubSet *subSet, int i, int j) {
-    for (int e = 0; e < subSet[j].length; e++) {
-        if (subSet[j].data[e] == i) {
-            setPixel(*B, i, j, 1);
-            return;
-        }
-    }
-    setPixel(*B, i, j, 0);
-}
+/*  Column "k" of the basis matrices is the bit mask (k << 1) | p for B0 and (k << 1) | !p for B1, where p is the
+    parity of "k": bit 0 completes the cardinality of the upper n-1 bits to an even (B0) or odd (B1) number, so the
+    2^(n-1) columns are all subsets of even or odd cardinality. Since the columns don't depend on n, the first 2^(n-1)
+    entries of the tables below are the basis matrices for all n up to BASIS_TABLE_MAX_N.
+*/
+#define BASIS_TABLE_MAX_N 8
 
-void printBooleanMatrix(BooleanMatrix *B, char *name) {
-    int n = B->height;
-    int m = B->width;
+#define PARITY7(k)   (((k) ^ (k) >> 1 ^ (k) >> 2 ^ (k) >> 3 ^ (k) >> 4 ^ (k) >> 5 ^ (k) >> 6) & 1)
+#define EVEN_MASK(k) ((k) << 1 | PARITY7(k))
+#define ODD_MASK(k)  ((k) << 1 | (PARITY7(k) ^ 1))
 
-    fprintf(stdout, "%2s:\n", name);
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < m; j++) {
-            fprintf(stdout, "%d", getPixel(*B, i, j));
-        }
-        fprintf(stdout, "\n");
-    }
-    fprintf(stdout, "\n");
-}
+#define MASKS2(M, k)   M(k), M((k) + 1)
+#define MASKS8(M, k)   MASKS2(M, k), MASKS2(M, (k) + 2), MASKS2(M, (k) + 4), MASKS2(M, (k) + 6)
+#define MASKS32(M, k)  MASKS8(M, k), MASKS8(M, (k) + 8), MASKS8(M, (k) + 16), MASKS8(M, (k) + 24)
+#define MASKS128(M, k) MASKS32(M, k), MASKS32(M, (k) + 32), MASKS32(M, (k) + 64), MASKS32(M, (k) + 96)
 
-void fillBasisMatrices(BooleanMatrix *B0, BooleanMatrix *B1) {
-    int n = B0->height;
-    int m = B0->width;
+static const uint8_t evenColumnMasks[1 << (BASIS_TABLE_MAX_N - 1)] = {MASKS128(EVEN_MASK, 0)};
+static const uint8_t oddColumnMasks[1 << (BASIS_TABLE_MAX_N - 1)] = {MASKS128(ODD_MASK, 0)};
 
-    Set set = createSet(n, m);
+void fillBasisColumnMasks(int *B0, int *B1, int n) {
+    int m = 1 << (n - 1);
 
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < m; j++) {
-            fillBasisMatrix(B0, set.even, i, j);
-            fillBasisMatrix(B1, set.odd, i, j);
+    if (n <= BASIS_TABLE_MAX_N) {
+        for (int k = 0; k < m; k++) {
+            B0[k] = evenColumnMasks[k];
+            B1[k] = oddColumnMasks[k];
         }
+        return;
     }
 
-    if (PRINT_SETS_AND_BASIS_MATRICES) {
-        printAllSubsets(&set);
-        printBooleanMatrix(B0, "B0");
-        printBooleanMatrix(B1, "B1");
+    for (int k = 0; k < m; k++) {
+        int p = parity(k);
+        B0[k] = k << 1 | p;
+        B1[k] = k << 1 | (p ^ 1);
     }
 }
@@ -8,7 +8,7 @@
 
 #include <stdint.h>
 
-#include "setsNsubsets.h"
+#include "bitTranspose.h"
 
 #ifndef TYPE_PIXEL
 #define TYPE_PIXEL
@@ -20,7 +20,8 @@ typedef uint8_t Pixel; /* black / white */
 typedef struct {
     int height;
     int width;
-    Pixel *array;
+    int stride;       // number of words per row
+    uint64_t *words;  // pixel (i, j) is bit (j % 64) of words[i * stride + j / 64]
 } BooleanMatrix;
 
 /*********************************************************************
@@ -28,7 +29,8 @@ typedef struct {
  *--------------------------------------------------------------------
  * Description:  Saves the size of a BooleanMatrix and allocates a 2D
  *               pixel array of the size, that is stored in the
- *               BooleanMatrix struct.
+ *               BooleanMatrix struct. The pixel are packed to 64 per
+ *               word, so each row starts at a new word.
  * Return:       The created BooleanMatrix.
  ********************************************************************/
 BooleanMatrix createBooleanMatrix(int height, int width);
@@ -41,53 +43,61 @@ BooleanMatrix createBooleanMatrix(int height, int width);
 void deleteBooleanMatrix(BooleanMatrix *matrix);
 
 /*********************************************************************
- * Function:     getPixel
+ * Function:     parity
  *--------------------------------------------------------------------
- * Description:  Return the value of the Pixel at row "i" and column
- *               "j" in a Booleanmatrix.
- * Return:       "1" is considered as a black pixel and "0" as white.
+ * Description:  Return 1, if an odd number of bits is set in "x",
+ *               and 0 otherwise.
  ********************************************************************/
-static inline Pixel getPixel(BooleanMatrix matrix, int i, int j) {
-    return matrix.array[i * matrix.width + j];
+static inline int parity(unsigned int x) {
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1;
 }
 
 /*********************************************************************
- * Function:     setPixel
+ * Function:     getPixelBits
  *--------------------------------------------------------------------
- * Description:  Set the Pixel at row "i" and column "j" in a
- *               BooleanMatrix to "value".
+ * Description:  Return "count" (1 to 64) pixel of row "i", starting
+ *               at column "j". Column "j" will be bit 0 of the result.
  ********************************************************************/
-static inline void setPixel(BooleanMatrix matrix, int i, int j, Pixel value) {
-    matrix.array[i * matrix.width + j] = value;
-}
+static inline uint64_t getPixelBits(BooleanMatrix matrix, int i, int j, int count) {
+    const uint64_t *words = &matrix.words[i * matrix.stride + (j >> 6)];
+    int shift = j & 63;
 
-/*********************************************************************
- * Function:     fillBasisMatrix
- *--------------------------------------------------------------------
- * Description:  Set the value of an element at row "i" and column "j"
- *               in a BooleanMatrix. The value of the element will
- *               be 1 (black) if the number behind "i" is part of the
- *               SubSet "subSet" and 0 (white) if not.
- ********************************************************************/
-void fillBasisMatrix(BooleanMatrix *B, SubSet *set, int i, int j);
+    uint64_t bits = words[0] >> shift;
+    if (shift + count > 64) {  // the pixel continue in the next word
+        bits |= words[1] << (64 - shift);
+    }
+    return count < 64 ? bits & (((uint64_t)1 << count) - 1) : bits;
+}
 
 /*********************************************************************
- * Function:     printBooleanMatrix
+ * Function:     transposeColumnMasks
  *--------------------------------------------------------------------
- * Description:  Print the contents of a BooleanMatrix array.
- *               To clarify which matrix is printed, a name with the
- *               length of two characters has to be given to it.
+ * Description:  Write the column masks masks[0] to masks[width-1] to
+ *               the columns 0 to width-1 of "dest", by the transpose
+ *               stage transposeVectorsToPlanes().
+ *               It is inlined, so callers with a constant size of
+ *               "dest" get the loops unrolled.
  ********************************************************************/
-void printBooleanMatrix(BooleanMatrix *B, char *name);
+static inline void transposeColumnMasks(BooleanMatrix *dest, const int *masks) {
+    transposeVectorsToPlanes(dest->words, dest->stride, masks, dest->width, dest->height);
+}
 
 /*********************************************************************
- * Function:     fillBasisMatrices
+ * Function:     fillBasisColumnMasks
  *--------------------------------------------------------------------
- * Description:  Calculate the basis matrices by creating subsets
- *               from a set with "n" elements.
- *               The even cardinality set is used to fill the basis
- *               matrix B0. The odd cardinality set is used to fill B1.
+ * Description:  Calculate the columns of the basis matrices for "n"
+ *               (2 to 31) shares as bit masks, in which bit "i" is the
+ *               pixel of row "i". B0 gets all 2^(n-1) masks with an
+ *               even number of set bits, B1 all masks with an odd one.
+ *               For n up to 8, they are copied from a table that is
+ *               precomputed at compile time.
+ * Output:       B0, B1 = vectors of 2^(n-1) column masks each
  ********************************************************************/
-void fillBasisMatrices(BooleanMatrix *B0, BooleanMatrix *B1);
+void fillBasisColumnMasks(int *B0, int *B1, int n);
 
 #endif /* BOOLEANMATRIX_H */
@@ -0,0 +1,154 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#include "chacha20.h"
+
+#include <string.h>
+
+#include "simdKernels.h"
+
+#define MAX_PARALLEL_BLOCKS 16  // blocks calculated side by side, one per vector lane
+#define DOUBLE_ROUNDS       10
+
+/*  one word of all parallel blocks, so every operation on it is a vector instruction,
+    as wide as the vector registers of the instruction set
+*/
+typedef uint32_t Lanes4 __attribute__((vector_size(4 * sizeof(uint32_t))));    // SSE2
+typedef uint32_t Lanes8 __attribute__((vector_size(8 * sizeof(uint32_t))));    // AVX2
+typedef uint32_t Lanes16 __attribute__((vector_size(16 * sizeof(uint32_t))));  // AVX-512
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/*  quarter round on the words a, b, c, d of all parallel blocks */
+#define QUARTER_ROUND(x, a, b, c, d)    \
+    do {                                \
+        x[a] += x[b];                   \
+        x[d] = ROTL32(x[d] ^ x[a], 16); \
+        x[c] += x[d];                   \
+        x[b] = ROTL32(x[b] ^ x[c], 12); \
+        x[a] += x[b];                   \
+        x[d] = ROTL32(x[d] ^ x[a], 8);  \
+        x[c] += x[d];                   \
+        x[b] = ROTL32(x[b] ^ x[c], 7);  \
+    } while (0)
+
+static inline uint32_t load32(const uint8_t *src) {
+    return (uint32_t)src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24;
+}
+
+static inline void store32(uint8_t *dest, uint32_t value) {
+    dest[0] = value;
+    dest[1] = value >> 8;
+    dest[2] = value >> 16;
+    dest[3] = value >> 24;
+}
+
+void initChaCha20(ChaCha20 *cipher, const uint8_t key[CHACHA20_KEY_SIZE], uint64_t nonce, uint64_t counter) {
+    for (int i = 0; i < 8; i++) {
+        cipher->key[i] = load32(key + 4 * i);
+    }
+    cipher->nonce = nonce;
+    cipher->counter = counter;
+}
+
+/*********************************************************************
+ * Function:     DEFINE_GENERATE_BLOCKS
+ *--------------------------------------------------------------------
+ * Description:  Defines the function "name", which calculates
+ *               "parallelBlocks" keystream blocks, starting at the
+ *               current counter of the cipher, and stores them one
+ *               after another in "dest".
+ *               The words of the blocks are stored "lane by lane"
+ *               (x[word][block]), so each step of the rounds is the
+ *               same operation on all blocks. "attributes" select the
+ *               instruction set the function is compiled for.
+ ********************************************************************/
+#define DEFINE_GENERATE_BLOCKS(name, Lanes, parallelBlocks, attributes)                   \
+    static attributes void name(ChaCha20 *cipher, uint8_t *dest) {                        \
+        Lanes input[16], x[16];                                                           \
+                                                                                          \
+        for (int lane = 0; lane < parallelBlocks; lane++) {                               \
+            uint64_t counter = cipher->counter + lane;                                    \
+            input[0][lane] = 0x61707865; /* "expand 32-byte k" */                         \
+            input[1][lane] = 0x3320646e;                                                  \
+            input[2][lane] = 0x79622d32;                                                  \
+            input[3][lane] = 0x6b206574;                                                  \
+            for (int i = 0; i < 8; i++) {                                                 \
+                input[4 + i][lane] = cipher->key[i];                                      \
+            }                                                                             \
+            input[12][lane] = (uint32_t)counter;                                          \
+            input[13][lane] = (uint32_t)(counter >> 32);                                  \
+            input[14][lane] = (uint32_t)cipher->nonce;                                    \
+            input[15][lane] = (uint32_t)(cipher->nonce >> 32);                            \
+        }                                                                                 \
+        memcpy(x, input, sizeof(x));                                                      \
+                                                                                          \
+        for (int round = 0; round < DOUBLE_ROUNDS; round++) {                             \
+            /* column round */                                                            \
+            QUARTER_ROUND(x, 0, 4, 8, 12);                                                \
+            QUARTER_ROUND(x, 1, 5, 9, 13);                                                \
+            QUARTER_ROUND(x, 2, 6, 10, 14);                                               \
+            QUARTER_ROUND(x, 3, 7, 11, 15);                                               \
+            /* diagonal round */                                                          \
+            QUARTER_ROUND(x, 0, 5, 10, 15);                                               \
+            QUARTER_ROUND(x, 1, 6, 11, 12);                                               \
+            QUARTER_ROUND(x, 2, 7, 8, 13);                                                \
+            QUARTER_ROUND(x, 3, 4, 9, 14);                                                \
+        }                                                                                 \
+                                                                                          \
+        for (int i = 0; i < 16; i++) {                                                    \
+            x[i] += input[i];                                                             \
+        }                                                                                 \
+        /* copy the vectors once to plain words, before they are stored block by block */ \
+        uint32_t words[16][parallelBlocks];                                               \
+        memcpy(words, x, sizeof(words));                                                  \
+        for (int lane = 0; lane < parallelBlocks; lane++) {                               \
+            for (int i = 0; i < 16; i++) {                                                \
+                store32(dest + lane * CHACHA20_BLOCK_SIZE + 4 * i, words[i][lane]);       \
+            }                                                                             \
+        }                                                                                 \
+        cipher->counter += parallelBlocks;                                                \
+    }
+
+DEFINE_GENERATE_BLOCKS(generateBlocks4, Lanes4, 4, )
+#ifdef SIMD_CLONES
+DEFINE_GENERATE_BLOCKS(generateBlocks8, Lanes8, 8, __attribute__((target("avx2"))))
+DEFINE_GENERATE_BLOCKS(generateBlocks16, Lanes16, 16, __attribute__((target("avx512f"))))
+#endif
+
+void generateChaCha20(ChaCha20 *cipher, uint8_t *dest, size_t size) {
+    void (*generateBlocks)(ChaCha20 *, uint8_t *) = generateBlocks4;
+    int parallelBlocks = 4;
+#ifdef SIMD_CLONES
+    switch (getSimdLevel()) {
+        case SIMD_LEVEL_AVX512:
+            generateBlocks = generateBlocks16;
+            parallelBlocks = 16;
+            break;
+        case SIMD_LEVEL_AVX2:
+            generateBlocks = generateBlocks8;
+            parallelBlocks = 8;
+            break;
+        default:
+            break;
+    }
+#endif
+
+    const size_t chunkSize = parallelBlocks * CHACHA20_BLOCK_SIZE;
+    uint8_t chunk[MAX_PARALLEL_BLOCKS * CHACHA20_BLOCK_SIZE];
+
+    // whole chunks are written directly to "dest"
+    for (; size >= chunkSize; size -= chunkSize, dest += chunkSize) {
+        generateBlocks(cipher, dest);
+    }
+
+    // the remaining blocks are taken from a temporary chunk
+    if (size) {
+        uint64_t usedBlocks = (size + CHACHA20_BLOCK_SIZE - 1) / CHACHA20_BLOCK_SIZE;
+        generateBlocks(cipher, chunk);
+        memcpy(dest, chunk, size);
+        cipher->counter -= parallelBlocks - usedBlocks;
+    }
+}
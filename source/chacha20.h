@@ -0,0 +1,43 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHACHA20_KEY_SIZE   32
+#define CHACHA20_BLOCK_SIZE 64
+
+typedef struct {
+    uint32_t key[8];
+    uint64_t nonce;
+    uint64_t counter;  // number of the next keystream block
+} ChaCha20;
+
+/*********************************************************************
+ * Function:     initChaCha20
+ *--------------------------------------------------------------------
+ * Description:  Prepares a ChaCha20 cipher (original variant with
+ *               64 bit nonce and 64 bit block counter) to generate
+ *               the keystream of "key" and "nonce", starting at
+ *               block "counter".
+ ********************************************************************/
+void initChaCha20(ChaCha20 *cipher, const uint8_t key[CHACHA20_KEY_SIZE], uint64_t nonce, uint64_t counter);
+
+/*********************************************************************
+ * Function:     generateChaCha20
+ *--------------------------------------------------------------------
+ * Description:  Writes the next keystream bytes to "dest". Several
+ *               blocks are calculated side by side, so the compiler
+ *               can use vector instructions for them.
+ *               Every call starts at a block boundary: if "size" is
+ *               not a multiple of CHACHA20_BLOCK_SIZE, the rest of
+ *               the last block is discarded.
+ ********************************************************************/
+void generateChaCha20(ChaCha20 *cipher, uint8_t *dest, size_t size);
+
+#endif /* CHACHA20_H */
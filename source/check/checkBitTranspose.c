@@ -0,0 +1,82 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Check of the bit transpose stage (run by "make check").
+
+    transposeVectorsToPlanes() has to write bit "i" of every vector to plane "i", like the
+    transposition bit by bit, for all numbers of planes and for counts, that end anywhere in the
+    blocks of 8 and 16 vectors and in the words of the planes. The bits of the planes behind the
+    count have to be zero, even if the planes held other bits before.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitTranspose.h"
+#include "random.h"
+
+#define CHECK_SEED       20230101
+#define CHECK_MAX_PLANES 31
+#define CHECK_MAX_COUNT  200
+#define CHECK_STRIDE     ((CHECK_MAX_COUNT + 63) / 64)
+
+static const int checkCounts[] = {1, 7, 8, 9, 15, 16, 17, 63, 64, 65, 100, 128, 143, CHECK_MAX_COUNT};
+
+/*********************************************************************
+ * Function:     transposeBitByBit
+ *--------------------------------------------------------------------
+ * Description:  Reference of transposeVectorsToPlanes(), which sets
+ *               every bit of the planes on its own.
+ ********************************************************************/
+static void transposeBitByBit(uint64_t *planes, const int *vectors, int count, int numPlanes) {
+    memset(planes, 0, (size_t)numPlanes * CHECK_STRIDE * sizeof(uint64_t));
+    for (int i = 0; i < numPlanes; i++) {
+        for (int j = 0; j < count; j++) {
+            planes[i * CHECK_STRIDE + j / 64] |= (uint64_t)((vectors[j] >> i) & 1) << (j % 64);
+        }
+    }
+}
+
+int main() {
+    int vectors[CHECK_MAX_COUNT];
+    uint64_t planes[CHECK_MAX_PLANES * CHECK_STRIDE], expected[CHECK_MAX_PLANES * CHECK_STRIDE];
+    int failed = 0, tests = 0;
+
+    randomSeed = CHECK_SEED;
+    useRandomSeed = 1;
+    RandomPool *randomSrc = createRandomPool();
+
+    for (int numPlanes = 1; numPlanes <= CHECK_MAX_PLANES; numPlanes++) {
+        for (size_t idx = 0; idx < sizeof(checkCounts) / sizeof(checkCounts[0]); idx++) {
+            int count = checkCounts[idx];
+            int words = (count + 63) / 64;
+
+            // the bits of the vectors above "numPlanes" have to be ignored
+            for (int j = 0; j < count; j++) {
+                vectors[j] = getRandomBits(randomSrc, CHECK_MAX_PLANES);
+            }
+            getRandomWords(randomSrc, planes, CHECK_MAX_PLANES * CHECK_STRIDE);
+            transposeVectorsToPlanes(planes, CHECK_STRIDE, vectors, count, numPlanes);
+            transposeBitByBit(expected, vectors, count, numPlanes);
+
+            int equal = 1;
+            for (int i = 0; i < numPlanes; i++) {
+                equal &= !memcmp(planes + i * CHECK_STRIDE, expected + i * CHECK_STRIDE, words * sizeof(uint64_t));
+            }
+            if (!equal) {
+                fprintf(stdout, "  %d planes of %d vectors: DIFFERENT PLANES\n", numPlanes, count);
+                failed++;
+            }
+            tests++;
+        }
+    }
+
+    fprintf(stdout, "Bit transpose against bit by bit, %d tests of 1 to %d planes\n", tests, CHECK_MAX_PLANES);
+    fprintf(stdout, failed ? "FAILED: %d tests\n\n" : "PASSED\n\n", failed);
+
+    closeRandomPool(randomSrc);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,506 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Check of the BMP reader (run by "make check").
+
+    One gray image is encoded in every layout the reader accepts. All of them have to be read to
+    the same packed pixel, by readBMP() and band by band by readBmpRows(). Malformed files have
+    to be rejected with customExitOnFailure(), instead of being read out of bounds.
+    The 1 bit files of createBMP() have to be read back unchanged for widths around a word, also
+    with set bits behind the end of the rows and with a palette of only one entry.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkSupport.h"
+#include "dataManagement.h"
+#include "fileManagement.h"
+#include "handleBMP.h"
+#include "memoryManagement.h"
+#include "settings.h"
+
+#define CHECK_WIDTH       37  // neither the 24 nor the 8 bit rows are a multiple of 4 bytes
+#define CHECK_HEIGHT      13
+#define CHECK_BAND_HEIGHT 5   // rows per readBmpRows() call, the last band is shorter
+#define BINARY_HEIGHT     3
+
+#define SIZE_FILE_HEADER   14
+#define SIZE_BIT_FIELDS    12
+#define SIZE_PALETTE_ENTRY 4
+#define BI_RGB             0
+#define BI_RLE8            1
+#define BI_BITFIELDS       3
+
+typedef enum {
+    PALETTE_NONE,
+    PALETTE_GRAY,     // entry "i" is the gray value "i"
+    PALETTE_SHUFFLED  // the gray values in a random order
+} PaletteType;
+
+typedef struct {
+    const char *name;
+    uint16_t bitsPerPixel;
+    uint32_t infoHeaderSize;
+    uint32_t compressionMethod;
+    int topDown;
+    PaletteType paletteType;
+    uint32_t numColors;  // palette entries, 0 = all 2^bitsPerPixel
+} BmpEncoding;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} BmpFile;
+
+static const BmpEncoding validEncodings[] = {
+    {"24 bit", 24, 40, BI_RGB, 0, PALETTE_NONE, 0},
+    {"32 bit", 32, 40, BI_RGB, 0, PALETTE_NONE, 0},
+    {"32 bit, bit fields after a 40 byte header", 32, 40, BI_BITFIELDS, 0, PALETTE_NONE, 0},
+    {"32 bit, V4 header with bit fields", 32, 108, BI_BITFIELDS, 0, PALETTE_NONE, 0},
+    {"32 bit, V5 header with bit fields", 32, 124, BI_BITFIELDS, 0, PALETTE_NONE, 0},
+    {"24 bit, top-down", 24, 40, BI_RGB, 1, PALETTE_NONE, 0},
+    {"8 bit gray palette", 8, 40, BI_RGB, 0, PALETTE_GRAY, 0},
+    {"8 bit random palette", 8, 40, BI_RGB, 0, PALETTE_SHUFFLED, 256},
+    {"8 bit random palette, top-down, V5 header", 8, 124, BI_RGB, 1, PALETTE_SHUFFLED, 0},
+};
+
+static const int32_t binaryWidths[] = {1, 63, 65, 70};
+
+static uint32_t checkRandomState = 12345;
+
+/*********************************************************************
+ * Function:     getCheckRandom
+ *--------------------------------------------------------------------
+ * Description:  Return a pseudo random number of 16 bit, so the
+ *               image of the check is the same on every run.
+ ********************************************************************/
+static uint32_t getCheckRandom() {
+    checkRandomState = checkRandomState * 1103515245 + 12345;
+    return checkRandomState >> 16;
+}
+
+static inline void putUint16(uint8_t *dest, uint16_t value) {
+    dest[0] = value;
+    dest[1] = value >> 8;
+}
+
+static inline void putUint32(uint8_t *dest, uint32_t value) {
+    putUint16(dest, value);
+    putUint16(dest + 2, value >> 16);
+}
+
+/*********************************************************************
+ * Function:     encodeBmp
+ *--------------------------------------------------------------------
+ * Description:  Encode the gray values "gray" (row 0 is the bottom
+ *               row) as a bmp file with the layout "encoding".
+ ********************************************************************/
+static BmpFile encodeBmp(const BmpEncoding *encoding, const uint8_t *gray) {
+    int bytesPerPixel = encoding->bitsPerPixel / 8;
+    size_t paddedWidth = ((size_t)CHECK_WIDTH * bytesPerPixel + 3) / 4 * 4;
+    uint32_t numColors = encoding->numColors;
+    uint32_t paletteEntries = 0;
+    if (encoding->paletteType != PALETTE_NONE) {
+        paletteEntries = numColors ? numColors : 1u << encoding->bitsPerPixel;
+    }
+    int bitFieldsAfterHeader = encoding->compressionMethod == BI_BITFIELDS && encoding->infoHeaderSize == 40;
+    size_t pixelDataOffset = SIZE_FILE_HEADER + encoding->infoHeaderSize +
+                             (bitFieldsAfterHeader ? SIZE_BIT_FIELDS : 0) + paletteEntries * SIZE_PALETTE_ENTRY;
+
+    BmpFile file = {.size = pixelDataOffset + paddedWidth * CHECK_HEIGHT};
+    file.data = xcalloc(file.size, 1);
+    uint8_t *data = file.data;
+
+    // file header and info header
+    data[0] = 'B';
+    data[1] = 'M';
+    putUint32(data + 2, file.size);
+    putUint32(data + 10, pixelDataOffset);
+    uint8_t *infoHeader = data + SIZE_FILE_HEADER;
+    putUint32(infoHeader, encoding->infoHeaderSize);
+    putUint32(infoHeader + 4, CHECK_WIDTH);
+    putUint32(infoHeader + 8, encoding->topDown ? -CHECK_HEIGHT : CHECK_HEIGHT);
+    putUint16(infoHeader + 12, 1);
+    putUint16(infoHeader + 14, encoding->bitsPerPixel);
+    putUint32(infoHeader + 16, encoding->compressionMethod);
+    putUint32(infoHeader + 20, paddedWidth * CHECK_HEIGHT);
+    putUint32(infoHeader + 24, 2835);
+    putUint32(infoHeader + 28, 2835);
+    putUint32(infoHeader + 32, numColors);
+
+    // the bit fields (red, green, blue, alpha) are part of the V4 and V5 headers
+    if (encoding->compressionMethod == BI_BITFIELDS || encoding->infoHeaderSize > 40) {
+        putUint32(infoHeader + 40, 0x00FF0000);
+        putUint32(infoHeader + 44, 0x0000FF00);
+        putUint32(infoHeader + 48, 0x000000FF);
+        if (encoding->infoHeaderSize > 40) {
+            putUint32(infoHeader + 52, 0xFF000000);
+        }
+    }
+
+    // the palette and the index of every gray value in it
+    uint8_t indexOfGray[256];
+    uint8_t *palette = infoHeader + encoding->infoHeaderSize + (bitFieldsAfterHeader ? SIZE_BIT_FIELDS : 0);
+    for (int i = 0; i < 256; i++) {
+        indexOfGray[i] = i;
+    }
+    if (encoding->paletteType == PALETTE_SHUFFLED) {
+        for (int i = 255; i > 0; i--) {
+            int j = getCheckRandom() % (i + 1);
+            uint8_t tmp = indexOfGray[i];
+            indexOfGray[i] = indexOfGray[j];
+            indexOfGray[j] = tmp;
+        }
+    }
+    for (int value = 0; value < 256 && (uint32_t)indexOfGray[value] < paletteEntries; value++) {
+        memset(palette + SIZE_PALETTE_ENTRY * indexOfGray[value], value, 3);
+    }
+
+    // the rows, bottom-up or top-down
+    for (int row = 0; row < CHECK_HEIGHT; row++) {
+        int fileRow = encoding->topDown ? CHECK_HEIGHT - 1 - row : row;
+        uint8_t *bmpRow = data + pixelDataOffset + paddedWidth * fileRow;
+        for (int column = 0; column < CHECK_WIDTH; column++) {
+            uint8_t value = gray[row * CHECK_WIDTH + column];
+            if (encoding->paletteType != PALETTE_NONE) {
+                bmpRow[column] = indexOfGray[value];
+            } else {
+                memset(bmpRow + bytesPerPixel * column, value, 3);
+                if (bytesPerPixel == 4) {
+                    bmpRow[4 * column + 3] = getCheckRandom();  // alpha or unused, which is ignored
+                }
+            }
+        }
+    }
+    return file;
+}
+
+/*********************************************************************
+ * Function:     readCheckBmp
+ *--------------------------------------------------------------------
+ * Description:  Read the bmp file at "path" with readBMP() to
+ *               "image".
+ ********************************************************************/
+static void readCheckBmp(const char *path, Image *image) {
+    image->file = xfopen(path, "rb");
+    readBMP(image);
+    xfclose(image->file);
+}
+
+/*********************************************************************
+ * Function:     readCheckBmpInBands
+ *--------------------------------------------------------------------
+ * Description:  Read the bmp file at "path" band by band with
+ *               readBmpRows(), like the streamed encryption, and
+ *               copy the bands to "image".
+ ********************************************************************/
+static void readCheckBmpInBands(const char *path, Image *image) {
+    BmpRows reader;
+    image->file = xfopen(path, "rb");
+    openBmpRows(image, &reader);
+    mallocPixelArray(image);
+
+    Image band = {.width = image->width, .height = CHECK_BAND_HEIGHT, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&band);
+    for (int firstRow = 0; firstRow < image->height; firstRow += CHECK_BAND_HEIGHT) {
+        band.height = image->height - firstRow < CHECK_BAND_HEIGHT ? image->height - firstRow : CHECK_BAND_HEIGHT;
+        readBmpRows(&reader, &band, firstRow);
+        memcpy(image->words + (size_t)firstRow * image->stride, band.words,
+               (size_t)band.height * band.stride * sizeof(uint64_t));
+    }
+
+    xfree(band.words);
+    closeBmpRows(&reader);
+    xfclose(image->file);
+}
+
+/*********************************************************************
+ * Function:     equalsExpectedPixel
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the packed "image" has the size and the
+ *               pixel of the packed image "expected".
+ ********************************************************************/
+static int equalsExpectedPixel(const Image *image, const Image *expected) {
+    return image->width == expected->width && image->height == expected->height &&
+           !memcmp(image->words, expected->words, (size_t)image->height * image->stride * sizeof(uint64_t));
+}
+
+/*********************************************************************
+ * Function:     checkValidBmp
+ *--------------------------------------------------------------------
+ * Description:  Encode the gray values "gray" with the layout
+ *               "encoding" and check, that readBMP() and readBmpRows()
+ *               read them to the pixel "expected".
+ * Return:       1 if the pixel are different, else 0.
+ ********************************************************************/
+static int checkValidBmp(const char *directory, const char *name, const BmpEncoding *encoding, const uint8_t *gray,
+                         const Image *expected) {
+    BmpFile file = encodeBmp(encoding, gray);
+    char *path = writeCheckFile(directory, "valid.bmp", file.data, file.size);
+
+    Image image = {.layout = PIXEL_LAYOUT_PACKED}, bandImage = {.layout = PIXEL_LAYOUT_PACKED};
+    readCheckBmp(path, &image);
+    readCheckBmpInBands(path, &bandImage);
+    int equal = equalsExpectedPixel(&image, expected) && equalsExpectedPixel(&bandImage, expected);
+    fprintf(stdout, "%-45s %s\n", name, equal ? "ok" : "DIFFERENT PIXEL");
+
+    xfree(bandImage.words);
+    xfree(image.words);
+    xfree(path);
+    xfree(file.data);
+    return !equal;
+}
+
+/*********************************************************************
+ * Function:     encodeBinaryBmp
+ *--------------------------------------------------------------------
+ * Description:  Encode the pixel "pixel" (one byte each, row 0 is the
+ *               bottom row) as a 1 bit bmp file, whose palette index
+ *               0 is white and 1 is black. The palette has
+ *               "numColors" entries, so for 1 entry black is the
+ *               index behind it. The unused bits at the end of each
+ *               row and the padding bytes are set to "unusedBits".
+ ********************************************************************/
+static BmpFile encodeBinaryBmp(const Pixel *pixel, int32_t width, uint32_t numColors, uint8_t unusedBits) {
+    size_t paddedWidth = ((size_t)width + 31) / 32 * 4;
+    size_t pixelDataOffset = SIZE_FILE_HEADER + 40 + numColors * SIZE_PALETTE_ENTRY;
+
+    BmpFile file = {.size = pixelDataOffset + paddedWidth * BINARY_HEIGHT};
+    file.data = xcalloc(file.size, 1);
+    uint8_t *data = file.data;
+
+    data[0] = 'B';
+    data[1] = 'M';
+    putUint32(data + 2, file.size);
+    putUint32(data + 10, pixelDataOffset);
+    uint8_t *infoHeader = data + SIZE_FILE_HEADER;
+    putUint32(infoHeader, 40);
+    putUint32(infoHeader + 4, width);
+    putUint32(infoHeader + 8, BINARY_HEIGHT);
+    putUint16(infoHeader + 12, 1);
+    putUint16(infoHeader + 14, 1);
+    putUint32(infoHeader + 20, paddedWidth * BINARY_HEIGHT);
+    putUint32(infoHeader + 32, numColors);
+    memset(infoHeader + 40, 255, 3);  // white, black (if present) is already zero
+
+    for (int row = 0; row < BINARY_HEIGHT; row++) {
+        uint8_t *bmpRow = data + pixelDataOffset + paddedWidth * row;
+        memset(bmpRow, 0, (width + 7) / 8);
+        memset(bmpRow + (width + 7) / 8, unusedBits, paddedWidth - (width + 7) / 8);
+        if (width % 8) {
+            bmpRow[width / 8] = unusedBits >> (width % 8);  // the leftmost pixel is the highest bit
+        }
+        for (int column = 0; column < width; column++) {
+            bmpRow[column / 8] |= pixel[row * width + column] << (7 - column % 8);
+        }
+    }
+    return file;
+}
+
+/*********************************************************************
+ * Function:     equalsBmpBody
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the pixel data of the bmp file at "path"
+ *               has the same bytes as the one of "expected".
+ ********************************************************************/
+static int equalsBmpBody(const char *path, const BmpFile *expected) {
+    uint32_t pixelDataOffset = expected->data[10] | expected->data[11] << 8;
+    size_t bodySize = expected->size - pixelDataOffset;
+    uint8_t *body = xmalloc(bodySize + 1);
+    uint8_t header[SIZE_FILE_HEADER];
+
+    FILE *file = xfopen(path, "rb");
+    xfread(header, 1, SIZE_FILE_HEADER, file, "ERR: read check file");
+    uint32_t writtenOffset = header[10] | header[11] << 8 | header[12] << 16 | (uint32_t)header[13] << 24;
+    fseek(file, writtenOffset, SEEK_SET);
+    int equal = fread(body, 1, bodySize + 1, file) == bodySize &&
+                !memcmp(body, expected->data + pixelDataOffset, bodySize);
+    xfclose(file);
+    xfree(body);
+    return equal;
+}
+
+/*********************************************************************
+ * Function:     checkBinaryBmp
+ *--------------------------------------------------------------------
+ * Description:  Write random pixel of "width" columns with
+ *               createBMP(), from a packed and a byte image, and read
+ *               them back. Then read 1 bit files with set unused bits,
+ *               with a palette of two and of one entry.
+ * Return:       The number of failed tests.
+ ********************************************************************/
+static int checkBinaryBmp(const char *directory, int32_t width) {
+    Pixel *pixel = xmalloc((size_t)width * BINARY_HEIGHT);
+    Image expected = {.width = width, .height = BINARY_HEIGHT, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&expected);
+    for (int row = 0; row < BINARY_HEIGHT; row++) {
+        for (int column = 0; column < width; column++) {
+            pixel[row * width + column] = getCheckRandom() % 2;
+        }
+        packPixelRow(pixel + row * width, expected.words + row * expected.stride, width);
+    }
+    BmpFile encoded = encodeBinaryBmp(pixel, width, 2, 0);
+    int failed = 0;
+
+    // round trip of both layouts, the written file has zero unused bits and padding
+    char *path = writeCheckFile(directory, "binary.bmp", NULL, 0);
+    Image byteImage = {.array = pixel, .width = width, .height = BINARY_HEIGHT, .layout = PIXEL_LAYOUT_BYTE};
+    const Image *written[] = {&expected, &byteImage};
+    for (int idx = 0; idx < 2; idx++) {
+        Image image = *written[idx], read = {.layout = PIXEL_LAYOUT_PACKED};
+        image.file = xfopen(path, "wb");
+        createBMP(&image);
+        xfclose(image.file);
+
+        readCheckBmp(path, &read);
+        int equal = equalsExpectedPixel(&read, &expected) && (BMP_BITS_PER_PIXEL != 1 || equalsBmpBody(path, &encoded));
+        char name[64];
+        snprintf(name, sizeof(name), "1 bit, width %d, written from %s pixel", width, idx ? "byte" : "packed");
+        fprintf(stdout, "%-45s %s\n", name, equal ? "ok" : "DIFFERENT PIXEL");
+        failed += !equal;
+        xfree(read.words);
+    }
+    xfree(path);
+    xfree(encoded.data);
+
+    // the unused bits have to be masked, a missing palette entry is black
+    for (uint32_t numColors = 2; numColors >= 1; numColors--) {
+        encoded = encodeBinaryBmp(pixel, width, numColors, 0xFF);
+        path = writeCheckFile(directory, "binary.bmp", encoded.data, encoded.size);
+        Image read = {.layout = PIXEL_LAYOUT_PACKED};
+        readCheckBmp(path, &read);
+        int equal = equalsExpectedPixel(&read, &expected);
+        char name[64];
+        snprintf(name, sizeof(name), "1 bit, width %d, unused bits set, %u colors", width, numColors);
+        fprintf(stdout, "%-45s %s\n", name, equal ? "ok" : "DIFFERENT PIXEL");
+        failed += !equal;
+        xfree(read.words);
+        xfree(path);
+        xfree(encoded.data);
+    }
+
+    xfree(expected.words);
+    xfree(pixel);
+    return failed;
+}
+
+/*********************************************************************
+ * Function:     readMalformedBmp
+ *--------------------------------------------------------------------
+ * Description:  Read the bmp file at "path", which has to be rejected,
+ *               in the child process of failsInChild().
+ ********************************************************************/
+static void readMalformedBmp(void *path) {
+    Image image = {.layout = PIXEL_LAYOUT_PACKED};
+    readCheckBmp(path, &image);
+}
+
+/*********************************************************************
+ * Function:     checkMalformedBmp
+ *--------------------------------------------------------------------
+ * Description:  Write the malformed "file" and check, that it is
+ *               rejected.
+ * Return:       1 if it was read, 0 if it was rejected.
+ ********************************************************************/
+static int checkMalformedBmp(const char *directory, const char *name, const BmpFile *file, size_t size) {
+    char *path = writeCheckFile(directory, "malformed.bmp", file->data, size);
+    int rejected = failsInChild(readMalformedBmp, path);
+    fprintf(stdout, "%-45s %s\n", name, rejected ? "rejected" : "NOT REJECTED");
+    xfree(path);
+    return !rejected;
+}
+
+int main() {
+    char *directory = createCheckDirectory();
+    int failed = 0;
+
+    /*  gray values of the whole range, but most of them close to the threshold, which gives
+        black for values up to THRESHOLD (the luminance of gray is the gray value)
+    */
+    uint8_t gray[CHECK_WIDTH * CHECK_HEIGHT];
+    Image expected = {.width = CHECK_WIDTH, .height = CHECK_HEIGHT, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&expected);
+    for (int i = 0; i < CHECK_WIDTH * CHECK_HEIGHT; i++) {
+        int value = i % 2 ? (int)(getCheckRandom() % 256) : THRESHOLD - 3 + (int)(getCheckRandom() % 8);
+        gray[i] = value < 0 ? 0 : value > 255 ? 255 : value;
+        uint64_t black = gray[i] <= THRESHOLD;
+        expected.words[(i / CHECK_WIDTH) * expected.stride + (i % CHECK_WIDTH) / 64] |= black << (i % CHECK_WIDTH % 64);
+    }
+
+    fprintf(stdout, "Valid BMP files:\n");
+    for (size_t idx = 0; idx < sizeof(validEncodings) / sizeof(validEncodings[0]); idx++) {
+        failed += checkValidBmp(directory, validEncodings[idx].name, &validEncodings[idx], gray, &expected);
+    }
+
+    /*  24 bit rows of pure black and white, like the ones of the shares, are read without
+        thresholding, until the first row with other colors (behind the first band)
+    */
+    uint8_t blackAndWhite[CHECK_WIDTH * CHECK_HEIGHT];
+    for (int i = 0; i < CHECK_WIDTH * CHECK_HEIGHT; i++) {
+        blackAndWhite[i] = gray[i] <= THRESHOLD ? 0 : 255;
+    }
+    failed += checkValidBmp(directory, "24 bit black and white", &validEncodings[0], blackAndWhite, &expected);
+    for (int i = (CHECK_BAND_HEIGHT + 1) * CHECK_WIDTH; i < CHECK_WIDTH * CHECK_HEIGHT; i++) {
+        blackAndWhite[i] = gray[i];
+    }
+    failed += checkValidBmp(directory, "24 bit black and white, then gray rows", &validEncodings[0], blackAndWhite,
+                            &expected);
+
+    fprintf(stdout, "\n1 bit BMP files:\n");
+    for (size_t idx = 0; idx < sizeof(binaryWidths) / sizeof(binaryWidths[0]); idx++) {
+        failed += checkBinaryBmp(directory, binaryWidths[idx]);
+    }
+
+    fprintf(stdout, "\nMalformed BMP files:\n");
+    const BmpEncoding rgb = validEncodings[0];
+    const BmpEncoding gray8 = validEncodings[6];
+    BmpEncoding encoding;
+    BmpFile file;
+
+    encoding = gray8;
+    encoding.compressionMethod = BI_RLE8;
+    file = encodeBmp(&encoding, gray);
+    failed += checkMalformedBmp(directory, "8 bit RLE", &file, file.size);
+    xfree(file.data);
+
+    file = encodeBmp(&rgb, gray);
+    putUint16(file.data + SIZE_FILE_HEADER + 14, 16);
+    failed += checkMalformedBmp(directory, "16 bit", &file, file.size);
+    xfree(file.data);
+
+    encoding = gray8;
+    encoding.numColors = 257;
+    file = encodeBmp(&encoding, gray);
+    failed += checkMalformedBmp(directory, "8 bit with 257 palette entries", &file, file.size);
+    xfree(file.data);
+
+    file = encodeBmp(&rgb, gray);
+    putUint32(file.data + 10, file.size + 1);
+    failed += checkMalformedBmp(directory, "pixel data offset behind the end", &file, file.size);
+    xfree(file.data);
+
+    file = encodeBmp(&rgb, gray);
+    failed += checkMalformedBmp(directory, "truncated body", &file, file.size - 1);
+    xfree(file.data);
+
+    file = encodeBmp(&rgb, gray);
+    putUint32(file.data + SIZE_FILE_HEADER + 8, (uint32_t)INT32_MIN);
+    failed += checkMalformedBmp(directory, "height INT32_MIN", &file, file.size);
+    xfree(file.data);
+
+    file = encodeBmp(&rgb, gray);
+    putUint32(file.data + SIZE_FILE_HEADER + 4, (1u << 30) + 1);
+    failed += checkMalformedBmp(directory, "width 2^30+1, whose row size wraps around", &file, file.size);
+    xfree(file.data);
+
+    fprintf(stdout, failed ? "FAILED: %d tests\n\n" : "PASSED\n\n", failed);
+
+    xfree(expected.words);
+    removeCheckDirectory(directory);
+    xfreeAll();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Statistical equivalence check of the deterministic algorithm (run by "make check").
+
+    The original algorithm permutated the columns of a basis matrix and then handed its rows to
+    the shares in a random order. The current one only permutates the column masks of the basis
+    matrix and gives row "i" to share "i", since a row permutation of B0 (B1) equals a column
+    permutation of it. Both are sampled here for n = 2 to 8 and each source color. For every
+    set of stacked shares, the distributions of the number of black pixel in the first half of
+    the stacked pixel expansion have to match, which is tested with a two sample chi-square
+    test. (The number of black pixel of the whole expansion is the same for any permutation, it
+    only gives the contrast.)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "booleanMatrix.h"
+#include "checkSupport.h"
+#include "dataManagement.h"
+#include "memoryManagement.h"
+#include "random.h"
+
+#define CHECK_SEED 20230101
+#define CHECK_MIN_SHARES 2
+#define CHECK_MAX_SHARES 8
+#define CHECK_PIXELS 100000  // sampled source pixel per number of shares, algorithm and color
+
+/*  The tests (one per set of stacked shares, n and color) together fail an equivalent
+    algorithm with a probability of about 1000 * CHECK_P_VALUE.
+*/
+#define CHECK_P_VALUE 1e-6
+
+#define MAX_WORDS ((1 << (CHECK_MAX_SHARES - 1)) / 64 + 1)  // words of a share row of m pixel
+
+typedef struct {
+    int n;
+    int m;
+    int stride;
+    uint64_t rows[CHECK_MAX_SHARES][MAX_WORDS];  // pixel expansion of each share, packed
+} Shares;
+
+/*********************************************************************
+ * Function:     encryptPixelWithRowShuffle
+ *--------------------------------------------------------------------
+ * Description:  Encrypt one source pixel like the original algorithm:
+ *               the columns of the n x m pixel basis matrix are
+ *               shuffled, then its rows are shuffled to the shares.
+ ********************************************************************/
+static void encryptPixelWithRowShuffle(Shares *shares, Pixel sourcePixel, RandomPool *randomSrc) {
+    int n = shares->n;
+    int m = shares->m;
+    int columnIndices[1 << (CHECK_MAX_SHARES - 1)];
+    int rowIndices[CHECK_MAX_SHARES];
+    Pixel basisMatrix[CHECK_MAX_SHARES][1 << (CHECK_MAX_SHARES - 1)];
+
+    // column "j" is the j-th subset of the shares with an even (B0) or odd (B1) cardinality
+    int column = 0;
+    for (int subset = 0; subset < 1 << n; subset++) {
+        if (parity(subset) == sourcePixel) {
+            for (int i = 0; i < n; i++) {
+                basisMatrix[i][column] = subset >> i & 1;
+            }
+            column++;
+        }
+    }
+
+    for (int j = 0; j < m; j++) {
+        columnIndices[j] = j;
+    }
+    for (int i = 0; i < n; i++) {
+        rowIndices[i] = i;
+    }
+    shuffleVector(columnIndices, m, randomSrc);
+    shuffleVector(rowIndices, n, randomSrc);
+
+    // for each share
+    for (int i = 0; i < n; i++) {
+        for (int word = 0; word < shares->stride; word++) {
+            shares->rows[i][word] = 0;
+        }
+        for (int j = 0; j < m; j++) {
+            uint64_t pixel = basisMatrix[rowIndices[i]][columnIndices[j]];
+            shares->rows[i][j / 64] |= pixel << (j % 64);
+        }
+    }
+}
+
+/*********************************************************************
+ * Function:     encryptPixelWithColumnMasks
+ *--------------------------------------------------------------------
+ * Description:  Encrypt one source pixel like the deterministic
+ *               algorithm: only the order of the column masks is
+ *               shuffled, and the transposed masks give the rows of
+ *               the shares.
+ ********************************************************************/
+static void encryptPixelWithColumnMasks(Shares *shares, const int *B0, const int *B1, BooleanMatrix *permutation,
+                                        Pixel sourcePixel, RandomPool *randomSrc) {
+    int m = shares->m;
+    const int *basisMatrix = sourcePixel ? B1 : B0;
+    int order[1 << (CHECK_MAX_SHARES - 1)];
+    int columns[1 << (CHECK_MAX_SHARES - 1)];
+
+    for (int j = 0; j < m; j++) {
+        order[j] = j;
+    }
+    shuffleVector(order, m, randomSrc);
+    for (int j = 0; j < m; j++) {
+        columns[j] = basisMatrix[order[j]];
+    }
+
+    for (int i = 0; i < shares->n * permutation->stride; i++) {
+        permutation->words[i] = 0;
+    }
+    transposeColumnMasks(permutation, columns);
+
+    // for each share
+    for (int i = 0; i < shares->n; i++) {
+        for (int word = 0; word < shares->stride; word++) {
+            shares->rows[i][word] = permutation->words[i * permutation->stride + word];
+        }
+    }
+}
+
+/*********************************************************************
+ * Function:     countStackedPixel
+ *--------------------------------------------------------------------
+ * Description:  Stack the shares of every non empty set "subset" and
+ *               count the sample in histogram[subset][number of
+ *               black pixel in the first half of the stacked pixel
+ *               expansion].
+ * Return:       The number of black pixel of all stacked shares.
+ ********************************************************************/
+static int countStackedPixel(const Shares *shares, long *histogram) {
+    uint64_t stacked[1 << CHECK_MAX_SHARES][MAX_WORDS] = {{0}};
+    int half = shares->m / 2;
+    uint64_t halfMask = half < 64 ? ((uint64_t)1 << half) - 1 : ~(uint64_t)0;
+    int count = 0;
+
+    for (int subset = 1; subset < 1 << shares->n; subset++) {
+        // the subset without its lowest share is stacked already
+        int lowest = __builtin_ctz(subset);
+        count = 0;
+        for (int word = 0; word < shares->stride; word++) {
+            stacked[subset][word] = stacked[subset & (subset - 1)][word] | shares->rows[lowest][word];
+            count += __builtin_popcountll(stacked[subset][word]);
+        }
+        histogram[subset * (half + 1) + __builtin_popcountll(stacked[subset][0] & halfMask)]++;
+    }
+    return count;  // of the last subset, which holds all shares
+}
+
+/*********************************************************************
+ * Function:     checkNumberOfShares
+ *--------------------------------------------------------------------
+ * Description:  Sample both algorithms for "n" shares and compare the
+ *               distributions of every set of stacked shares.
+ * Return:       The number of failed tests.
+ ********************************************************************/
+static int checkNumberOfShares(int n, RandomPool *randomSrc) {
+    int m = 1 << (n - 1);
+    int bins = m / 2 + 1;
+    int failed = 0;
+
+    Shares shares = {.n = n, .m = m, .stride = (m + 63) / 64};
+    int *B0 = xmalloc(m * sizeof(int));
+    int *B1 = xmalloc(m * sizeof(int));
+    fillBasisColumnMasks(B0, B1, n);
+    BooleanMatrix permutation = createBooleanMatrix(n, m);
+
+    long *rowShuffleHistogram = xmalloc((size_t)(1 << n) * bins * sizeof(long));
+    long *columnMaskHistogram = xmalloc((size_t)(1 << n) * bins * sizeof(long));
+
+    for (Pixel sourcePixel = 0; sourcePixel <= 1; sourcePixel++) {
+        memset(rowShuffleHistogram, 0, (size_t)(1 << n) * bins * sizeof(long));
+        memset(columnMaskHistogram, 0, (size_t)(1 << n) * bins * sizeof(long));
+
+        // black pixel of all n stacked shares: m-1 for a white source pixel, m for a black one
+        int contrastFailed = 0;
+
+        // both algorithms get their own random numbers, so the samples are independent
+        seekRandomPool(randomSrc, 2 * sourcePixel, n);
+        for (int pixel = 0; pixel < CHECK_PIXELS; pixel++) {
+            encryptPixelWithRowShuffle(&shares, sourcePixel, randomSrc);
+            countStackedPixel(&shares, rowShuffleHistogram);
+        }
+        seekRandomPool(randomSrc, 2 * sourcePixel + 1, n);
+        for (int pixel = 0; pixel < CHECK_PIXELS; pixel++) {
+            encryptPixelWithColumnMasks(&shares, B0, B1, &permutation, sourcePixel, randomSrc);
+            contrastFailed |= countStackedPixel(&shares, columnMaskHistogram) != m - 1 + sourcePixel;
+        }
+
+        double minPValue = 1, maxChiSquare = 0;
+        for (int subset = 1; subset < 1 << n; subset++) {
+            double chiSquare;
+            double pValue = calcChiSquarePValue(&rowShuffleHistogram[subset * bins],
+                                                &columnMaskHistogram[subset * bins], bins, &chiSquare);
+            if (pValue < CHECK_P_VALUE) {
+                fprintf(stdout, "  n = %d, %s pixel, shares 0x%02x: chi^2 = %.1f, p = %.2e\n", n,
+                        sourcePixel ? "black" : "white", subset, chiSquare, pValue);
+                failed++;
+            }
+            minPValue = pValue < minPValue ? pValue : minPValue;
+            maxChiSquare = chiSquare > maxChiSquare ? chiSquare : maxChiSquare;
+        }
+
+        fprintf(stdout, "n = %d, %s pixel: %3d sets of shares, max chi^2 = %6.1f, min p = %.3f, %s\n", n,
+                sourcePixel ? "black" : "white", (1 << n) - 1, maxChiSquare, minPValue,
+                contrastFailed ? "CONTRAST FAILED" : "contrast ok");
+        failed += contrastFailed;
+    }
+
+    xfree(columnMaskHistogram);
+    xfree(rowShuffleHistogram);
+    deleteBooleanMatrix(&permutation);
+    xfree(B1);
+    xfree(B0);
+    return failed;
+}
+
+int main() {
+    randomSeed = CHECK_SEED;
+    useRandomSeed = 1;
+    RandomPool *randomSrc = createRandomPool();
+    int failed = 0;
+
+    fprintf(stdout, "Row shuffle against column masks, %d pixel per sample:\n", CHECK_PIXELS);
+    for (int n = CHECK_MIN_SHARES; n <= CHECK_MAX_SHARES; n++) {
+        failed += checkNumberOfShares(n, randomSrc);
+    }
+    fprintf(stdout, failed ? "FAILED: %d tests\n" : "PASSED\n", failed);
+
+    closeRandomPool(randomSrc);
+    xfreeAll();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Statistical equivalence check of the (k,n) random grid algorithm (run by "make check").
+
+    The original algorithm encrypted a pixel with a (k,k) random grid, an XOR chain of k-1 random
+    bits and the source pixel, and spread its k pixel to k shares in a random order. The other
+    shares got random bits. The current one picks a random subset of k shares, draws n random
+    bits and flips the lowest bit of the subset, if the parity of the subset doesn't match the
+    source pixel. Both have to give the same distribution of the n share pixel of a source pixel,
+    which is tested with a two sample chi-square test over all 2^n combinations.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "checkSupport.h"
+#include "memoryManagement.h"
+#include "random.h"
+#include "vcAlg03_randomGrid.h"
+#include "vcAlgorithms.h"
+
+#define CHECK_SEED    20230101
+#define CHECK_WIDTH   1000
+#define CHECK_HEIGHT  100  // CHECK_WIDTH * CHECK_HEIGHT sampled source pixel per (k,n) and color
+#define CHECK_P_VALUE 1e-6
+#define CHECK_MAX_N   (SPECIALIZED_MAX_N + 1)  // the generic kernel is used for it
+
+typedef struct {
+    int n;
+    int k;
+} ThresholdScheme;
+
+static const ThresholdScheme checkSchemes[] = {
+    {2, 2}, {3, 2}, {3, 3}, {4, 2}, {4, 3}, {5, 3}, {6, 4}, {8, 5}, {CHECK_MAX_N, 5},
+};
+
+/*********************************************************************
+ * Function:     encryptPixelWithXorChain
+ *--------------------------------------------------------------------
+ * Description:  Return the n share pixel (bit "i" is share "i") of
+ *               "sourcePixel", encrypted like the original algorithm.
+ ********************************************************************/
+static int encryptPixelWithXorChain(int n, int k, int sourcePixel, RandomPool *randomSrc) {
+    int order[CHECK_MAX_N];
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    shuffleVector(order, n, randomSrc);
+
+    // the first k shares of the order get the (k,k) random grid, the last one the XOR chain
+    int sharePixel = 0;
+    int chain = sourcePixel;
+    for (int i = 0; i < k - 1; i++) {
+        int bit = getRandomBits(randomSrc, 1);
+        chain ^= bit;
+        sharePixel |= bit << order[i];
+    }
+    sharePixel |= chain << order[k - 1];
+    for (int i = k; i < n; i++) {
+        sharePixel |= (int)getRandomBits(randomSrc, 1) << order[i];
+    }
+    return sharePixel;
+}
+
+/*********************************************************************
+ * Function:     checkDistribution
+ *--------------------------------------------------------------------
+ * Description:  Sample both algorithms for (k,n) and each source color
+ *               and compare the distributions of the share pixel.
+ * Return:       The number of failed tests.
+ ********************************************************************/
+static int checkDistribution(int n, int k, RandomPool *randomSrc) {
+    int bins = 1 << n;
+    int failed = 0;
+    long *xorChainHistogram = xmalloc(bins * sizeof(long));
+    long *subsetHistogram = xmalloc(bins * sizeof(long));
+
+    Image source = {.width = CHECK_WIDTH, .height = CHECK_HEIGHT, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&source);
+    Image shares[CHECK_MAX_N];
+    mallocSharesOfSourceSize(&source, shares, n, PIXEL_LAYOUT_PACKED);
+    SubsetTable subsets = createSubsetTable(n, k);
+
+    for (int sourcePixel = 0; sourcePixel <= 1; sourcePixel++) {
+        for (int i = 0; i < bins; i++) {
+            xorChainHistogram[i] = subsetHistogram[i] = 0;
+        }
+
+        // both algorithms get their own random numbers, so the samples are independent
+        seekRandomPool(randomSrc, 1, sourcePixel);
+        for (int pixel = 0; pixel < CHECK_WIDTH * CHECK_HEIGHT; pixel++) {
+            xorChainHistogram[encryptPixelWithXorChain(n, k, sourcePixel, randomSrc)]++;
+        }
+
+        for (int row = 0; row < CHECK_HEIGHT; row++) {
+            for (int word = 0; word < source.stride; word++) {
+                source.words[row * source.stride + word] = sourcePixel ? ~(uint64_t)0 : 0;
+            }
+            source.words[row * source.stride + source.stride - 1] &= getRowTailMask(CHECK_WIDTH);
+        }
+        distributeRandomGrids_kn(&source, shares, &subsets, randomSrc, sourcePixel * CHECK_HEIGHT);
+        for (int row = 0; row < CHECK_HEIGHT; row++) {
+            for (int column = 0; column < CHECK_WIDTH; column++) {
+                int sharePixel = 0;
+                for (int idx = 0; idx < n; idx++) {
+                    sharePixel |= getImagePixel(&shares[idx], row, column) << idx;
+                }
+                subsetHistogram[sharePixel]++;
+            }
+        }
+
+        double chiSquare;
+        double pValue = calcChiSquarePValue(xorChainHistogram, subsetHistogram, bins, &chiSquare);
+        fprintf(stdout, "(k,n) = (%d,%d), %s pixel: %3d combinations, chi^2 = %6.1f, p = %.3f%s\n", k, n,
+                sourcePixel ? "black" : "white", bins, chiSquare, pValue, pValue < CHECK_P_VALUE ? ", FAILED" : "");
+        failed += pValue < CHECK_P_VALUE;
+    }
+
+    xfree(subsetHistogram);
+    xfree(xorChainHistogram);
+    return failed;
+}
+
+int main() {
+    int failed = 0;
+
+    randomSeed = CHECK_SEED;
+    useRandomSeed = 1;
+    RandomPool *randomSrc = createRandomPool();
+
+    fprintf(stdout, "(k,k) XOR chain against subset masks, %d pixel per sample:\n", CHECK_WIDTH * CHECK_HEIGHT);
+    for (size_t idx = 0; idx < sizeof(checkSchemes) / sizeof(checkSchemes[0]); idx++) {
+        failed += checkDistribution(checkSchemes[idx].n, checkSchemes[idx].k, randomSrc);
+    }
+    fprintf(stdout, failed ? "FAILED: %d tests\n\n" : "PASSED\n\n", failed);
+
+    closeRandomPool(randomSrc);
+    xfreeAll();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
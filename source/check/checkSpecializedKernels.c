@@ -0,0 +1,127 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Check of the specialized kernels (run by "make check").
+
+    The deterministic and the (k,n) random grid algorithm have an instance of their hot loop for
+    every n up to SPECIALIZED_MAX_N. Each instance has to give the same shares as the generic
+    version, which is used for larger n, with the same random numbers. The instances are static,
+    so the sources of the algorithms are included here (and their objects aren't linked).
+*/
+
+#include "vcAlg01_deterministic.c"
+#include "vcAlg03_randomGrid.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "checkSupport.h"
+
+#define CHECK_SEED   20230101
+#define CHECK_WIDTH  100  // several tiles of the deterministic algorithm for every n
+#define CHECK_HEIGHT 3
+
+/*********************************************************************
+ * Function:     equalsShares
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the packed shares "a" and "b" of "n"
+ *               shares have the same pixel.
+ ********************************************************************/
+static int equalsShares(const Image *a, const Image *b, int n) {
+    for (int idx = 0; idx < n; idx++) {
+        if (memcmp(a[idx].words, b[idx].words, (size_t)a[idx].height * a[idx].stride * sizeof(uint64_t))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*********************************************************************
+ * Function:     checkDeterministicKernel
+ *--------------------------------------------------------------------
+ * Description:  Encrypt "source" to "n" shares with the instance of
+ *               encryptSourceRowWith() for "n" and with the generic
+ *               version, and compare the shares.
+ * Return:       1 if the shares are different, else 0.
+ ********************************************************************/
+static int checkDeterministicKernel(Image *source, RandomPool *randomSrc, int n) {
+    Image specialized[SPECIALIZED_MAX_N], generic[SPECIALIZED_MAX_N];
+    AlgorithmData data = {.source = source, .shares = specialized, .numberOfShares = n, .randomSrc = randomSrc};
+    deterministicData *dData = prepareDeterministicAlgorithm(&data);
+    mallocPixelExpandedShares(source, generic, n, 1 << (n - 1), PIXEL_LAYOUT_PACKED);
+
+    const EncryptSourceRow instances[2] = {encryptSourceRowTable[n], encryptSourceRowGeneric};
+    Image *shares[2] = {specialized, generic};
+    for (int version = 0; version < 2; version++) {
+        for (int row = 0; row < source->height; row++) {
+            seekRandomPool(randomSrc, 0, row);
+            instances[version](dData, row, shares[version], row * dData->deterministicHeight);
+        }
+        streamFence();
+    }
+
+    int equal = equalsShares(specialized, generic, n);
+    char name[64];
+    snprintf(name, sizeof(name), "deterministic, n = %d", n);
+    fprintf(stdout, "%-45s %s\n", name, equal ? "ok" : "DIFFERENT SHARES");
+    return !equal;
+}
+
+/*********************************************************************
+ * Function:     checkRandomGridKernel
+ *--------------------------------------------------------------------
+ * Description:  Encrypt "source" to "n" shares with the instance of
+ *               distributeRandomGridsWith() for "n" and with the
+ *               generic version for (k,n), and compare the shares.
+ * Return:       1 if the shares are different, else 0.
+ ********************************************************************/
+static int checkRandomGridKernel(Image *source, RandomPool *randomSrc, int n, int k) {
+    Image specialized[SPECIALIZED_MAX_N], generic[SPECIALIZED_MAX_N];
+    mallocSharesOfSourceSize(source, specialized, n, PIXEL_LAYOUT_PACKED);
+    mallocSharesOfSourceSize(source, generic, n, PIXEL_LAYOUT_PACKED);
+    SubsetTable subsets = createSubsetTable(n, k);
+
+    distributeRandomGridsTable[n](source, specialized, &subsets, randomSrc, 0);
+    distributeRandomGridsWith(source, generic, &subsets, randomSrc, 0, n);
+
+    int equal = equalsShares(specialized, generic, n);
+    char name[64];
+    snprintf(name, sizeof(name), "random grid (k,n), n = %d, k = %d", n, k);
+    fprintf(stdout, "%-45s %s\n", name, equal ? "ok" : "DIFFERENT SHARES");
+    return !equal;
+}
+
+int main() {
+    char *directory = createCheckDirectory();
+    int failed = 0;
+
+    randomSeed = CHECK_SEED;
+    useRandomSeed = 1;
+    basisStorePath = directory;
+    RandomPool *randomSrc = createRandomPool();
+
+    Image source = {.width = CHECK_WIDTH, .height = CHECK_HEIGHT, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&source);
+    for (int row = 0; row < CHECK_HEIGHT; row++) {
+        getRandomWords(randomSrc, source.words + row * source.stride, source.stride);
+        source.words[row * source.stride + source.stride - 1] &= getRowTailMask(CHECK_WIDTH);
+    }
+
+    fprintf(stdout, "Specialized against generic kernels, seed %d:\n", CHECK_SEED);
+    for (int n = 2; n <= SPECIALIZED_MAX_N; n++) {
+        failed += checkDeterministicKernel(&source, randomSrc, n);
+    }
+    for (int n = 2; n <= SPECIALIZED_MAX_N; n++) {
+        for (int k = 2; k <= n; k++) {
+            failed += checkRandomGridKernel(&source, randomSrc, n, k);
+        }
+    }
+    fprintf(stdout, failed ? "FAILED: %d tests\n\n" : "PASSED\n\n", failed);
+
+    closeRandomPool(randomSrc);
+    removeCheckDirectory(directory);
+    xfreeAll();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
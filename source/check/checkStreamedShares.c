@@ -0,0 +1,202 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Check of the streamed encryption (run by "make check").
+
+    With a seed, the shares only depend on the seed, the image, the algorithm and n and k. So the
+    share files of every algorithm have to be the same bytes, whether the source is read band by
+    band (STREAM_ROW_BANDS set) or as a whole image. Both ways are run like in callAlgorithm(), each
+    in a child process, since the program ends with xcloseAll() and xfreeAll().
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "basisStore.h"
+#include "checkSupport.h"
+#include "dataManagement.h"
+#include "fileManagement.h"
+#include "handleBMP.h"
+#include "memoryManagement.h"
+#include "random.h"
+#include "vcAlg01_deterministic.h"
+#include "vcAlg02_probabilistic.h"
+#include "vcAlg03_randomGrid.h"
+#include "vcAlgorithms.h"
+
+#define CHECK_SEED   20230101
+#define CHECK_WIDTH  70   // the last word of a packed row is only partly used
+#define CHECK_HEIGHT 150  // several bands of STREAM_BAND_HEIGHT rows, the last one is shorter
+
+typedef struct {
+    const char *name;
+    void (*algorithm)(AlgorithmData *);
+    int algorithmNumber;
+    int numberOfShares;
+    int k;        // asked by the (k,n) random grid algorithm, else 0
+    int streamed;
+} EncryptionRun;
+
+static const EncryptionRun encryptionRuns[] = {
+    {"deterministic, n = 3", deterministicAlgorithm, 0, 3, 0, 0},
+    {"deterministic, n = 9 (not specialized)", deterministicAlgorithm, 0, 9, 0, 0},
+    {"probabilistic, n = 4", probabilisticAlgorithm, 0, 4, 0, 0},
+    {"random grid (n,n), n = 3", callRandomGridAlgorithm, 1, 3, 0, 0},
+    {"random grid (2,n), n = 4", callRandomGridAlgorithm, 2, 4, 0, 0},
+    {"random grid (k,n), n = 5, k = 3", callRandomGridAlgorithm, 3, 5, 3, 0},
+    {"random grid (k,n), n = 2", callRandomGridAlgorithm, 3, 2, 0, 0},
+};
+
+/*********************************************************************
+ * Function:     encryptSource
+ *--------------------------------------------------------------------
+ * Description:  Encrypt the source like callAlgorithm(), but with the
+ *               numbers of the EncryptionRun "argument" instead of
+ *               the ones of the user, and streamed or not.
+ ********************************************************************/
+static void encryptSource(void *argument) {
+    const EncryptionRun *run = argument;
+    int numberOfShares = run->numberOfShares;
+
+    // the algorithm asks for k on stdin, its prompts are not shown
+    if (!freopen("/dev/null", "w", stdout)) {
+        customExitOnFailure("ERR: redirect stdout");
+    }
+    if (run->k) {
+        char input[8];
+        snprintf(input, sizeof(input), "%d\n", run->k);
+        char *inputPath = writeCheckFile(sharePath, "input.txt", (const uint8_t *)input, strlen(input));
+        if (!freopen(inputPath, "r", stdin)) {
+            customExitOnFailure("ERR: redirect stdin");
+        }
+    }
+
+    Image source, *shares = xmalloc(numberOfShares * sizeof(Image));
+    BmpRows sourceRows;
+
+    if (run->streamed) {
+        source.file = xfopen(sourcePath, "rb");
+        openBmpRows(&source, &sourceRows);
+    } else {
+        createSourceImage(&source);
+    }
+    deleteShareFiles();
+    createShareFiles(shares, numberOfShares);
+
+    RandomPool *randomSrc = createRandomPool();
+
+    AlgorithmData data = {.source = &source,
+                          .shares = shares,
+                          .numberOfShares = numberOfShares,
+                          .algorithmNumber = run->algorithmNumber,
+                          .randomSrc = randomSrc,
+                          .sourceRows = run->streamed ? &sourceRows : NULL};
+    run->algorithm(&data);
+
+    if (!data.sharesWritten) {
+        drawShareFiles(shares, numberOfShares);
+    }
+    if (data.sourceRows) {
+        closeBmpRows(data.sourceRows);
+    }
+
+    closeRandomPool(randomSrc);
+    xcloseAll();
+    xfreeAll();
+}
+
+/*********************************************************************
+ * Function:     readShareFile
+ *--------------------------------------------------------------------
+ * Description:  Read the whole file "share<number>.bmp" in "directory"
+ *               to a new buffer.
+ * Output:       size = number of bytes of the file
+ ********************************************************************/
+static uint8_t *readShareFile(const char *directory, int number, size_t *size) {
+    size_t pathLen = strlen(directory) + 13;
+    char *path = xmalloc(pathLen);
+    snprintf(path, pathLen, "%s/share%02d.bmp", directory, number);
+
+    FILE *file = xfopen(path, "rb");
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = xmalloc(*size);
+    xfread(data, 1, *size, file, "ERR: read share file");
+    xfclose(file);
+    xfree(path);
+    return data;
+}
+
+/*********************************************************************
+ * Function:     equalsShareFiles
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the "numberOfShares" share files of the
+ *               directories "a" and "b" have the same bytes.
+ ********************************************************************/
+static int equalsShareFiles(const char *a, const char *b, int numberOfShares) {
+    int equal = 1;
+    for (int i = 1; i <= numberOfShares && equal; i++) {
+        size_t sizeA, sizeB;
+        uint8_t *dataA = readShareFile(a, i, &sizeA);
+        uint8_t *dataB = readShareFile(b, i, &sizeB);
+        equal = sizeA == sizeB && !memcmp(dataA, dataB, sizeA);
+        xfree(dataB);
+        xfree(dataA);
+    }
+    return equal;
+}
+
+int main() {
+    char *directory = createCheckDirectory();
+    char *streamedDirectory = createCheckDirectory();
+    char *wholeDirectory = createCheckDirectory();
+    int failed = 0;
+
+    randomSeed = CHECK_SEED;
+    useRandomSeed = 1;
+    basisStorePath = directory;
+
+    // a random black and white source image
+    size_t pathLen = strlen(directory) + 12;
+    sourcePath = xmalloc(pathLen);
+    snprintf(sourcePath, pathLen, "%s/source.bmp", directory);
+    Image source = {.width = CHECK_WIDTH, .height = CHECK_HEIGHT, .layout = PIXEL_LAYOUT_BYTE};
+    mallocPixelArray(&source);
+    RandomPool *randomSrc = createRandomPool();
+    for (int i = 0; i < CHECK_WIDTH * CHECK_HEIGHT; i++) {
+        source.array[i] = getRandomBits(randomSrc, 1);
+    }
+    closeRandomPool(randomSrc);
+    source.file = xfopen(sourcePath, "wb");
+    createBMP(&source);
+    xfclose(source.file);
+    xfree(source.array);
+
+    fprintf(stdout, "Streamed against whole image shares, seed %d:\n", CHECK_SEED);
+    for (size_t idx = 0; idx < sizeof(encryptionRuns) / sizeof(encryptionRuns[0]); idx++) {
+        EncryptionRun run = encryptionRuns[idx];
+
+        run.streamed = 1;
+        sharePath = streamedDirectory;
+        int encrypted = succeedsInChild(encryptSource, &run);
+        run.streamed = 0;
+        sharePath = wholeDirectory;
+        encrypted = encrypted && succeedsInChild(encryptSource, &run);
+
+        int equal = encrypted && equalsShareFiles(streamedDirectory, wholeDirectory, run.numberOfShares);
+        fprintf(stdout, "%-45s %s\n", run.name, !encrypted ? "ENCRYPTION FAILED" : equal ? "ok" : "DIFFERENT SHARES");
+        failed += !equal;
+    }
+    fprintf(stdout, failed ? "FAILED: %d tests\n\n" : "PASSED\n\n", failed);
+
+    xfree(sourcePath);
+    removeCheckDirectory(wholeDirectory);
+    removeCheckDirectory(streamedDirectory);
+    removeCheckDirectory(directory);
+    xfreeAll();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
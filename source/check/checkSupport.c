@@ -0,0 +1,137 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#include "checkSupport.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "dataManagement.h"
+#include "memoryManagement.h"
+
+#define CHECK_MIN_BIN_SAMPLES 20
+
+// Global, like in visualCrypt.c
+char *sourcePath = NULL;
+char *sharePath = NULL;
+uint64_t randomSeed = 0;
+int useRandomSeed = 0;
+int verbose = 0;
+
+char *createCheckDirectory() {
+    static const char template[] = "/tmp/visualCryptCheckXXXXXX";
+    char *directory = xmalloc(sizeof(template));
+    memcpy(directory, template, sizeof(template));
+    if (!mkdtemp(directory)) {
+        customExitOnFailure("ERR: create check directory");
+    }
+    return directory;
+}
+
+void removeCheckDirectory(char *directory) {
+    DIR *dir = opendir(directory);
+    if (dir) {
+        size_t pathLen = strlen(directory) + 258;
+        char *path = xmalloc(pathLen);
+        struct dirent *entry;
+        while ((entry = readdir(dir))) {
+            if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+                snprintf(path, pathLen, "%s/%s", directory, entry->d_name);
+                remove(path);
+            }
+        }
+        closedir(dir);
+        xfree(path);
+    }
+    remove(directory);
+    xfree(directory);
+}
+
+char *writeCheckFile(const char *directory, const char *name, const uint8_t *data, size_t size) {
+    size_t pathLen = strlen(directory) + strlen(name) + 2;
+    char *path = xmalloc(pathLen);
+    snprintf(path, pathLen, "%s/%s", directory, name);
+
+    FILE *file = fopen(path, "wb");
+    if (!file || fwrite(data, 1, size, file) != size || fclose(file)) {
+        customExitOnFailure("ERR: write check file");
+    }
+    return path;
+}
+
+/*********************************************************************
+ * Function:     runInChild
+ *--------------------------------------------------------------------
+ * Description:  Call function(argument) in a child process, which
+ *               exits with EXIT_SUCCESS, if the function returns. Its
+ *               error messages are discarded, if "discardErrors" is
+ *               set.
+ * Return:       The status of the child given by waitpid().
+ ********************************************************************/
+static int runInChild(void (*function)(void *), void *argument, int discardErrors) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        customExitOnFailure("ERR: fork check process");
+    }
+    if (pid == 0) {
+        if (discardErrors) {
+            int devNull = open("/dev/null", O_WRONLY);
+            dup2(devNull, STDERR_FILENO);
+        }
+        function(argument);
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return status;
+}
+
+int failsInChild(void (*function)(void *), void *argument) {
+    int status = runInChild(function, argument, 1);
+    return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE;  // a crash is no rejection
+}
+
+int succeedsInChild(void (*function)(void *), void *argument) {
+    int status = runInChild(function, argument, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+double calcChiSquarePValue(const long *a, const long *b, int bins, double *chiSquare) {
+    double statistic = 0;
+    int degreesOfFreedom = -1;
+    long pooledA = 0, pooledB = 0;
+
+    for (int bin = 0; bin < bins; bin++) {
+        if (a[bin] + b[bin] < CHECK_MIN_BIN_SAMPLES) {
+            pooledA += a[bin];
+            pooledB += b[bin];
+            continue;
+        }
+        double difference = a[bin] - b[bin];
+        statistic += difference * difference / (a[bin] + b[bin]);
+        degreesOfFreedom++;
+    }
+    if (pooledA + pooledB > 0) {
+        double difference = pooledA - pooledB;
+        statistic += difference * difference / (pooledA + pooledB);
+        degreesOfFreedom++;
+    }
+
+    *chiSquare = statistic;
+    if (degreesOfFreedom <= 0) {  // all samples in a single bin
+        return 1;
+    }
+    double k = degreesOfFreedom;
+    double z = (cbrt(statistic / k) - (1 - 2 / (9 * k))) / sqrt(2 / (9 * k));
+    return 0.5 * erfc(z / sqrt(2));
+}
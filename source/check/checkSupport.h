@@ -0,0 +1,74 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#ifndef CHECK_SUPPORT_H
+#define CHECK_SUPPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*  The checks of "make check" are linked with all objects of the program except visualCrypt.o,
+    so checkSupport.c defines the globals of visualCrypt.c for them.
+*/
+
+/*********************************************************************
+ * Function:     createCheckDirectory
+ *--------------------------------------------------------------------
+ * Description:  Create an empty temporary directory for the files of
+ *               a check and return its path.
+ ********************************************************************/
+char *createCheckDirectory();
+
+/*********************************************************************
+ * Function:     removeCheckDirectory
+ *--------------------------------------------------------------------
+ * Description:  Remove the directory of createCheckDirectory() with
+ *               all files in it.
+ ********************************************************************/
+void removeCheckDirectory(char *directory);
+
+/*********************************************************************
+ * Function:     writeCheckFile
+ *--------------------------------------------------------------------
+ * Description:  Write the "size" bytes of "data" to a new file
+ *               "name" in "directory" and return its path.
+ ********************************************************************/
+char *writeCheckFile(const char *directory, const char *name, const uint8_t *data, size_t size);
+
+/*********************************************************************
+ * Function:     failsInChild
+ *--------------------------------------------------------------------
+ * Description:  Call function(argument) in a child process, whose
+ *               error messages are discarded. Used for input, which
+ *               the program has to reject with customExitOnFailure().
+ * Return:       1 if the child exited with EXIT_FAILURE, 0 if the
+ *               function returned or the child crashed.
+ ********************************************************************/
+int failsInChild(void (*function)(void *), void *argument);
+
+/*********************************************************************
+ * Function:     succeedsInChild
+ *--------------------------------------------------------------------
+ * Description:  Call function(argument) in a child process, so it can
+ *               use xcloseAll() and xfreeAll() of the program.
+ * Return:       1 if the child exited with EXIT_SUCCESS (or the
+ *               function returned), else 0.
+ ********************************************************************/
+int succeedsInChild(void (*function)(void *), void *argument);
+
+/*********************************************************************
+ * Function:     calcChiSquarePValue
+ *--------------------------------------------------------------------
+ * Description:  Return the p-value of the two sample chi-square test
+ *               of the histograms "a" and "b" with "bins" bins, which
+ *               have the same number of samples. Bins with less than
+ *               CHECK_MIN_BIN_SAMPLES samples are pooled, so the
+ *               chi-square approximation holds. The p-value is
+ *               calculated by the Wilson-Hilferty approximation.
+ * Output:       chiSquare = the test statistic
+ ********************************************************************/
+double calcChiSquarePValue(const long *a, const long *b, int bins, double *chiSquare);
+
+#endif /* CHECK_SUPPORT_H */
@@ -0,0 +1,77 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+/*  Check of the luminance threshold (run by "make check").
+
+    thresholdBgrToPixels() and thresholdBgrToWords() have to decide every one of the 2^24 colors
+    like the rule in settings.h: a pixel is white, if 0.2126 red + 0.7152 green + 0.0722 blue,
+    rounded half up to an integer, is greater than THRESHOLD. The reference calculates it in
+    floating point, with the sum of the integer weights divided by 10000, so the colors exactly
+    on a boundary (a luminance of x.5) aren't rounded the wrong way by the inexact weights.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "settings.h"
+#include "simdKernels.h"
+
+#define CHECK_PRINTED_MISMATCHES 10
+
+/*********************************************************************
+ * Function:     isBlackReference
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the color is black by the rule of
+ *               settings.h, 0 if it is white.
+ * Output:       onBoundary = set to 1, if the luminance is exactly
+ *               THRESHOLD + 0.5, which is rounded up to white
+ ********************************************************************/
+static Pixel isBlackReference(int red, int green, int blue, int *onBoundary) {
+    double luminance = (2126.0 * red + 7152.0 * green + 722.0 * blue) / 10000;
+    *onBoundary = luminance == THRESHOLD + 0.5;
+    return floor(luminance + 0.5) <= THRESHOLD;
+}
+
+int main() {
+    uint8_t bgr[256 * 3], bgra[256 * 4];
+    Pixel pixel[256];
+    uint64_t words[4];
+    long mismatches = 0, boundaryColors = 0, blackColors = 0;
+
+    // for each red and green value, all blue values are thresholded in one row
+    for (int red = 0; red < 256; red++) {
+        for (int green = 0; green < 256; green++) {
+            for (int blue = 0; blue < 256; blue++) {
+                bgr[3 * blue] = bgra[4 * blue] = blue;
+                bgr[3 * blue + 1] = bgra[4 * blue + 1] = green;
+                bgr[3 * blue + 2] = bgra[4 * blue + 2] = red;
+                bgra[4 * blue + 3] = red ^ green;  // alpha, which is ignored
+            }
+            thresholdBgrToPixels(bgr, pixel, 256, 3);
+            thresholdBgrToWords(bgra, words, 256, 4);
+
+            for (int blue = 0; blue < 256; blue++) {
+                int onBoundary;
+                Pixel black = isBlackReference(red, green, blue, &onBoundary);
+                Pixel wordPixel = words[blue / 64] >> (blue % 64) & 1;
+                boundaryColors += onBoundary;
+                blackColors += black;
+                if (pixel[blue] != black || wordPixel != black) {
+                    if (mismatches < CHECK_PRINTED_MISMATCHES) {
+                        fprintf(stdout, "  red %3d, green %3d, blue %3d: reference %s, kernels %d %d\n", red, green,
+                                blue, black ? "black" : "white", pixel[blue], wordPixel);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    fprintf(stdout, "Threshold %d of all colors: %ld black, %ld with a luminance of exactly %d.5, %ld mismatches\n",
+            THRESHOLD, blackColors, boundaryColors, THRESHOLD, mismatches);
+    fprintf(stdout, mismatches ? "FAILED\n\n" : "PASSED\n\n");
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
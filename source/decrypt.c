@@ -9,22 +9,8 @@
 #include "handleBMP.h"
 #include "memoryManagement.h"
 #include "menu.h"
-
-/*********************************************************************
- * Function:     orTwoPixelArrays
- *--------------------------------------------------------------------
- * Description:  The pixel array of "dest" will be the result of
- *               itself OR-ed with the pixel array from "source".
- ********************************************************************/
-static void orTwoPixelArrays(Image *dest, Image *source) {
-    int height = dest->height;
-    int width = dest->width;
-
-    // for each pixel
-    for (int i = 0; i < height * width; i++) {
-        dest->array[i] |= source->array[i];
-    }
-}
+#include "settings.h"
+#include "simdKernels.h"
 
 /*********************************************************************
  * Function:     fillDecryptedImage
@@ -33,16 +19,31 @@ static void orTwoPixelArrays(Image *dest, Image *source) {
  *               overlapping multiple share pixel arrays. This makes
  *               use of the OR-function for each pixel of the shares
  *               and will put them all together in "decrypted".
+ *               All shares are stacked in a single pass by
+ *               stackBytes(), which works on byte and packed pixel
+ *               arrays alike.
  ********************************************************************/
 static void fillDecryptedImage(Image *decrypted, Image *share, int numberOfShares) {
     decrypted->height = share->height;
     decrypted->width = share->width;
-    decrypted->array = share->array;
+    decrypted->layout = share->layout;
+    mallocPixelArray(decrypted);
+
+    int packed = decrypted->layout == PIXEL_LAYOUT_PACKED;
+    size_t size = packed ? (size_t)decrypted->stride * decrypted->height * sizeof(uint64_t)
+                         : (size_t)decrypted->width * decrypted->height;
+    const uint8_t **sources = xmalloc(numberOfShares * sizeof(uint8_t *));
 
     // for each share
-    for (int i = 1; i < numberOfShares; i++) {
-        orTwoPixelArrays(decrypted, share + i);
+    for (int i = 0; i < numberOfShares; i++) {
+        if (share[i].width != share->width || share[i].height != share->height || share[i].layout != share->layout) {
+            customExitOnFailure("ERR: the shares to decrypt differ in size");
+        }
+        sources[i] = packed ? (const uint8_t *)share[i].words : share[i].array;
     }
+
+    stackBytes(packed ? (uint8_t *)decrypted->words : decrypted->array, sources, numberOfShares, size);
+    xfree(sources);
 }
 
 void decryptShareFiles() {
@@ -52,18 +53,19 @@ void decryptShareFiles() {
     do {
         clear();
         fprintf(stdout,
-                "Shares can be decrypted from share01.bmp to share08.bmp\n"
+                "Shares can be decrypted from share01.bmp to share%02d.bmp\n"
                 "The result will be stored in the same directory and named\n"
                 "decrypted01.bmp to a maximum of decrypted99.bmp\n"
-                "(decrypted01.bmp will be overwritten if max is reached)\n\n");
+                "(decrypted01.bmp will be overwritten if max is reached)\n\n",
+                MAX_NUMBER_OF_SHARES);
 
-        valid = getNumber("Enter number of the FIRST share to decrypt: ", 1, 8, &first);
+        valid = getNumber("Enter number of the FIRST share to decrypt: ", 1, MAX_NUMBER_OF_SHARES, &first);
     } while (!valid);
 
     // get number of the last share from user
     do {
         clear();
-        valid = getNumber("Enter number of the LAST share to decrypt: ", 1, 8, &last);
+        valid = getNumber("Enter number of the LAST share to decrypt: ", 1, MAX_NUMBER_OF_SHARES, &last);
     } while (!valid);
 
     if (first > last) {
@@ -80,6 +82,8 @@ void decryptShareFiles() {
     fillDecryptedImage(&result, shares, numberOfShares);
     createBMP(&result);
 
+    printVerbose("SIMD kernels: %s\n", getSimdLevelName());
+
     xcloseAll();
     xfreeAll();
     fprintf(stdout, "Success!\n");
@@ -5,12 +5,23 @@
 
 #include "handleBMP.h"
 
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "fileManagement.h"
 #include "memoryManagement.h"
 #include "settings.h"
+#include "simdKernels.h"
 
 #define SIZE_BMP_HEADER     54
+#define SIZE_FILE_HEADER    14
 #define BYTES_PER_RGB_PIXEL 3
+#define SIZE_PALETTE_ENTRY  4  // blue, green, red, reserved
+#define BI_RGB              0  // compression methods
+#define BI_BITFIELDS        3
+#define WRITE_BUFFER_SIZE   (1 << 20)  // rows are converted to rgb-values in chunks of about this size
 
 typedef struct {
     char padForAlignment[2];  // extend header size to multiple of 4 bytes
@@ -35,8 +46,31 @@ typedef struct {
     uint32_t numImportantColors;
 } BmpHeader;
 
-static inline uint32_t roundToMultipleOf4(uint32_t x) {
-    return (x + 3) & ~3;
+/*********************************************************************
+ * Function:     getPaddedWidth
+ *--------------------------------------------------------------------
+ * Description:  Return the number of bytes per row of the pixel data
+ *               of a bmp with "width" pixel and "bitsPerPixel" bits
+ *               per pixel, including the padding to 4 bytes. It is
+ *               calculated in 64 bit, so it can't overflow for any
+ *               width of the header.
+ ********************************************************************/
+static inline uint64_t getPaddedWidth(int32_t width, int bitsPerPixel) {
+    return ((uint64_t)width * bitsPerPixel + 31) / 32 * 4;
+}
+
+/*********************************************************************
+ * Function:     reverseBitsInBytes
+ *--------------------------------------------------------------------
+ * Description:  Reverse the order of the bits in each byte of "x".
+ *               The leftmost pixel of a byte of a 1 bit bmp is its
+ *               highest bit, the one of packed pixel the lowest.
+ ********************************************************************/
+static inline uint64_t reverseBitsInBytes(uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return x;
 }
 
 /*_____________________________________WRITE_OPERATIONS_____________________________________*/
@@ -47,29 +81,35 @@ static inline uint32_t roundToMultipleOf4(uint32_t x) {
  * Description:  Each BMP file has a header in front of its pixel
  *               data. This function will create a valid BMP header in
  *               order to create a new BMP file.
+ *               A palette of "numColors" entries follows the header.
  * Input:        width = width of the new BMP file in pixel,
- *               height = height of the new BMP file in pixel
+ *               height = height of the new BMP file in pixel,
+ *               bitsPerPixel = 1 (with palette) or 24 (rgb values),
+ *               numColors = number of entries of the palette
  ********************************************************************/
-static void writeBmpHeader(BmpHeader *bmpHeader, int32_t width, int32_t height) {
+static void writeBmpHeader(BmpHeader *bmpHeader, int32_t width, int32_t height, int bitsPerPixel, int numColors) {
+    uint32_t pixelDataOffset = SIZE_BMP_HEADER + numColors * SIZE_PALETTE_ENTRY;
+    uint32_t pixelArraySize = getPaddedWidth(width, bitsPerPixel) * height;
+
     // 14 Byte BMP Fileheader
     bmpHeader->bitmapSignatureBytes[0] = 'B';
     bmpHeader->bitmapSignatureBytes[1] = 'M';
-    bmpHeader->fileSize = SIZE_BMP_HEADER + width * height * BYTES_PER_RGB_PIXEL;
+    bmpHeader->fileSize = pixelDataOffset + pixelArraySize;
     bmpHeader->reserved = 0xdeadbeef;
-    bmpHeader->pixelDataOffset = SIZE_BMP_HEADER;
+    bmpHeader->pixelDataOffset = pixelDataOffset;
 
     // 40 Byte BitMapInfoHeader
     bmpHeader->infoHeaderSize = 40;
     bmpHeader->widthInPixel = width;
     bmpHeader->heightInPixel = height;
     bmpHeader->numColorPlanes = 1;
-    bmpHeader->bitsPerPixel = BYTES_PER_RGB_PIXEL * 8;
+    bmpHeader->bitsPerPixel = bitsPerPixel;
     bmpHeader->compressionMethod = 0;
-    bmpHeader->bmpPixelArraySize = width * height * BYTES_PER_RGB_PIXEL;
+    bmpHeader->bmpPixelArraySize = pixelArraySize;
     bmpHeader->horizontalResolution = 2048;
     bmpHeader->verticalResolution = 2048;
-    bmpHeader->numColorsInPalette = 0;
-    bmpHeader->numImportantColors = 0;
+    bmpHeader->numColorsInPalette = numColors;
+    bmpHeader->numImportantColors = numColors;
 }
 
 /*********************************************************************
@@ -77,46 +117,119 @@ static void writeBmpHeader(BmpHeader *bmpHeader, int32_t width, int32_t height)
  *--------------------------------------------------------------------
  * Description:  This function must be called after writeBmpHeader()
  *               to create a bmp file properly. It will take the
- *               content of the pixel array "source", where the value
- *               "0" is considered as white and every other number is
- *               considered as black.
+ *               content of the pixel array of "image" in either
+ *               layout, where the value "0" is considered as white and
+ *               every other number is considered as black.
  *               If the source pixel is white, the rgb values of the
  *               corresponding destination pixel, interpreted as bmp
  *               color data, are all set to 255. For black pixel they
  *               are set to 0.
- * Input:        source = most likely a boolean pixel array with
- *                        the values 0 = white and 1 = black,
- *               width = width of the new BMP file in pixel,
- *               height = height of the new BMP file in pixel,
+ * Input:        image = most likely a boolean pixel array with
+ *                       the values 0 = white and 1 = black,
+ *               firstRow = first row of "image" to convert,
+ *               numRows = number of rows to convert
  * Output:       destination = array that will get the rgb values of
  *               the bmp file
  ********************************************************************/
-static void writeBmpBody(const Pixel *source, Pixel *destination, int32_t width, int32_t height) {
-    Pixel p_source;
-    int32_t paddedWidth = roundToMultipleOf4(BYTES_PER_RGB_PIXEL * width);
-    for (int32_t row = 0; row < height; row++) {
-        for (int32_t column = 0; column < width; column++) {
-            p_source = source[row * width + column] ? 0 : 255;           // black = 0, white = 255
-            destination[row * paddedWidth + column * 3] = p_source;      // blue
-            destination[row * paddedWidth + column * 3 + 1] = p_source;  // green
-            destination[row * paddedWidth + column * 3 + 2] = p_source;  // red
+static void writeBmpBody(const Image *image, Pixel *destination, int32_t firstRow, int32_t numRows) {
+    int32_t width = image->width;
+    size_t paddedWidth = getPaddedWidth(width, BYTES_PER_RGB_PIXEL * 8);
+
+    // packed images are unpacked row by row
+    Pixel *rowBuffer = image->layout == PIXEL_LAYOUT_PACKED ? xmalloc(width) : NULL;
+
+    for (int32_t row = firstRow; row < firstRow + numRows; row++) {
+        const Pixel *source = image->array + (size_t)row * width;
+        if (rowBuffer) {
+            unpackPixelRow(image->words + (size_t)row * image->stride, rowBuffer, width);
+            source = rowBuffer;
         }
+        Pixel *bmpRow = destination + (size_t)(row - firstRow) * paddedWidth;
+        expandPixelsToBgr(source, bmpRow, width);
+        memset(bmpRow + BYTES_PER_RGB_PIXEL * width, 0, paddedWidth - BYTES_PER_RGB_PIXEL * width);  // padding
     }
+
+    xfree(rowBuffer);
 }
 
-void createBMP(Image *image) {
+/*********************************************************************
+ * Function:     writePalettizedBmpBody
+ *--------------------------------------------------------------------
+ * Description:  Same as writeBmpBody(), but for 1 bit bmp files,
+ *               whose palette index 0 is white and 1 is black. So
+ *               the bits of a packed row are the bmp row already, but
+ *               in the opposite order within each byte.
+ ********************************************************************/
+static void writePalettizedBmpBody(const Image *image, uint8_t *destination, int32_t firstRow, int32_t numRows) {
     int32_t width = image->width;
-    int32_t height = image->height;
-    uint32_t bmpSize = SIZE_BMP_HEADER + roundToMultipleOf4(BYTES_PER_RGB_PIXEL * width) * height;
+    int32_t stride = (width + 63) / 64;
+    uint32_t rowBytes = (width + 7) / 8;
+    size_t paddedWidth = getPaddedWidth(width, 1);
+
+    // byte images are packed row by row
+    uint64_t *rowBuffer = image->layout == PIXEL_LAYOUT_BYTE ? xmalloc(stride * sizeof(uint64_t)) : NULL;
+
+    for (int32_t row = firstRow; row < firstRow + numRows; row++) {
+        const uint64_t *source = image->words + (size_t)row * stride;
+        if (rowBuffer) {
+            packPixelRow(image->array + (size_t)row * width, rowBuffer, width);
+            source = rowBuffer;
+        }
+        uint8_t *bmpRow = destination + (size_t)(row - firstRow) * paddedWidth;
+
+        // for each word of the row, the unused bits of the last one are zero
+        for (int32_t word = 0; word < stride; word++) {
+            uint32_t first = 8 * word;
+            uint32_t last = rowBytes < first + 8 ? rowBytes : first + 8;
+            uint64_t bits = reverseBitsInBytes(source[word]);
+            for (uint32_t i = first; i < last; i++) {
+                bmpRow[i] = bits >> (8 * (i - first));
+            }
+        }
+        memset(bmpRow + rowBytes, 0, paddedWidth - rowBytes);  // padding
+    }
+
+    xfree(rowBuffer);
+}
+
+void startBMP(Image *image) {
+    // palette index 0 is white and 1 is black, like the pixel values
+    static const uint8_t palette[2 * SIZE_PALETTE_ENTRY] = {255, 255, 255, 0, 0, 0, 0, 0};
+    int numColors = BMP_BITS_PER_PIXEL == 1 ? 2 : 0;
+
+    BmpHeader header;
+    writeBmpHeader(&header, image->width, image->height, numColors ? 1 : BYTES_PER_RGB_PIXEL * 8, numColors);
+    xfwrite((uint8_t *)&header + 2, 1, SIZE_BMP_HEADER, image->file, "ERR: create BMP");
+    if (numColors) {
+        xfwrite(palette, SIZE_PALETTE_ENTRY, numColors, image->file, "ERR: create BMP");
+    }
+}
+
+void appendBmpRows(Image *image, const Image *rows) {
+    int palettized = BMP_BITS_PER_PIXEL == 1;
+    size_t paddedWidth = getPaddedWidth(rows->width, palettized ? 1 : BYTES_PER_RGB_PIXEL * 8);
+    int32_t chunkRows = paddedWidth < WRITE_BUFFER_SIZE ? WRITE_BUFFER_SIZE / paddedWidth : 1;
+    if (chunkRows > rows->height) {
+        chunkRows = rows->height;
+    }
 
-    // create BMP file content
-    uint8_t *bmpBuffer = xmalloc(bmpSize + 2);
-    writeBmpHeader((BmpHeader *)bmpBuffer, width, height);
-    writeBmpBody(image->array, bmpBuffer + sizeof(BmpHeader), width, height);
+    // the rows are written in chunks, so the buffer doesn't grow with the image
+    uint8_t *bodyBuffer = xmalloc(paddedWidth * chunkRows);
+    for (int32_t firstRow = 0; firstRow < rows->height; firstRow += chunkRows) {
+        int32_t numRows = rows->height - firstRow < chunkRows ? rows->height - firstRow : chunkRows;
+        if (palettized) {
+            writePalettizedBmpBody(rows, bodyBuffer, firstRow, numRows);
+        } else {
+            writeBmpBody(rows, bodyBuffer, firstRow, numRows);
+        }
+        xfwrite(bodyBuffer, 1, paddedWidth * numRows, image->file, "ERR: create BMP");
+    }
+    xfree(bodyBuffer);
+}
 
-    // write content to file
-    xfwrite(bmpBuffer + 2, 1, bmpSize, image->file, "ERR: create BMP");
-    xfree(bmpBuffer);
+void createBMP(Image *image) {
+    startBMP(image);
+    appendBmpRows(image, image);
 }
 
 /*_____________________________________READ_OPERATIONS_____________________________________*/
@@ -126,79 +239,311 @@ void createBMP(Image *image) {
  *--------------------------------------------------------------------
  * Description:  Each BMP file has a header in front of its pixel
  *               data. This function will store the bmp header
- *               information in a BmpHeader structure.
- *               Note: This will position the file offset of "file"
- *               to the start of the pixel data.
+ *               information of the mapped file "fileData" in a
+ *               BmpHeader structure, whose fields are aligned.
  ********************************************************************/
-static inline void readBmpHeader(FILE *file, BmpHeader *headerInformation) {
-    size_t bufferSize = sizeof(BmpHeader);
-    xfread(((uint8_t *)headerInformation) + 2, 1, bufferSize - 2, file, "ERR: read BMP header information");
+static inline void readBmpHeader(const uint8_t *fileData, BmpHeader *headerInformation) {
+    memcpy(((uint8_t *)headerInformation) + 2, fileData, SIZE_BMP_HEADER);
 }
 
 /*********************************************************************
  * Function:     verifyBmpHeaderInformation
  *--------------------------------------------------------------------
  * Description:  The program can only read BMP files structured
- *               in a specific (yet common) way. If the input file
- *               got data structured differently, the program wont
+ *               in a specific (yet common) way: uncompressed rgb
+ *               values (24 bit), rgb values with an alpha or unused
+ *               byte (32 bit, also with the bit fields of that
+ *               layout) or palette indices (1 and 8 bit). The info
+ *               header can be the one of version 3 to 5, the rows can
+ *               be stored bottom-up or top-down (negative height).
+ *               If the input file got data structured differently,
+ *               or its pixel data doesn't fit into the "fileSize"
+ *               bytes of the mapped file "fileData", the program wont
  *               be able to read them and abort.
  ********************************************************************/
-static inline void verifyBmpHeaderInformation(const BmpHeader *headerInformation) {
+static inline void verifyBmpHeaderInformation(const BmpHeader *headerInformation, const uint8_t *fileData,
+                                              size_t fileSize) {
+    uint32_t infoHeaderSize = headerInformation->infoHeaderSize;
+    uint16_t bitsPerPixel = headerInformation->bitsPerPixel;
+    uint32_t compressionMethod = headerInformation->compressionMethod;
+    int32_t height = headerInformation->heightInPixel;
+
+    // the palette of 1 and 8 bit files follows the info header, zero colors means all 2^bitsPerPixel
+    uint64_t numColors = 0;
+    if (bitsPerPixel <= 8) {
+        numColors = headerInformation->numColorsInPalette ? headerInformation->numColorsInPalette : 1u << bitsPerPixel;
+    }
+
+    // the bit fields follow the info header of version 3, the later ones contain them
+    int bitFields = compressionMethod == BI_BITFIELDS;
+    uint64_t minDataOffset = SIZE_FILE_HEADER + infoHeaderSize + (bitFields && infoHeaderSize == 40 ? 12 : 0) +
+                             numColors * SIZE_PALETTE_ENTRY;
+
     if (headerInformation->bitmapSignatureBytes[0] != 'B' || headerInformation->bitmapSignatureBytes[1] != 'M' ||
-        headerInformation->pixelDataOffset != SIZE_BMP_HEADER || headerInformation->infoHeaderSize != 40 ||
-        headerInformation->bitsPerPixel != BYTES_PER_RGB_PIXEL * 8 || headerInformation->compressionMethod != 0) {
+        (infoHeaderSize != 40 && infoHeaderSize != 52 && infoHeaderSize != 56 && infoHeaderSize != 108 &&
+         infoHeaderSize != 124) ||
+        (bitsPerPixel != 1 && bitsPerPixel != 8 && bitsPerPixel != 24 && bitsPerPixel != 32) ||
+        numColors > (uint64_t)1 << bitsPerPixel || (compressionMethod != BI_RGB && !bitFields) ||
+        (bitFields && bitsPerPixel != 32) || headerInformation->pixelDataOffset < minDataOffset ||
+        headerInformation->widthInPixel <= 0 || height == 0 || height == INT32_MIN) {
         customExitOnFailure("ERR: found invalid BMP file");
     }
+
+    // divide instead of multiplying, so a huge width or height can't wrap the size of the pixel data around
+    uint64_t paddedWidth = getPaddedWidth(headerInformation->widthInPixel, bitsPerPixel);
+    uint64_t numRows = height < 0 ? -(int64_t)height : height;
+    if (headerInformation->pixelDataOffset > fileSize ||
+        paddedWidth > (fileSize - headerInformation->pixelDataOffset) / numRows) {
+        customExitOnFailure("ERR: invalid BMP body information");
+    }
+
+    // only the bit fields of blue, green and red bytes (and one more byte) can be read
+    if (bitFields) {
+        uint32_t masks[3];
+        memcpy(masks, fileData + SIZE_BMP_HEADER, sizeof(masks));
+        if (masks[0] != 0x00FF0000 || masks[1] != 0x0000FF00 || masks[2] != 0x000000FF) {
+            customExitOnFailure("ERR: found invalid BMP file");
+        }
+    }
 }
 
 /*********************************************************************
- * Function:     readBmpBody
+ * Function:     readBmpPalette
  *--------------------------------------------------------------------
- * Description:  This function has to be called after readBmpHeader().
- *               It will read the rgb values of the opened bmp file
- *               image->file and calculates if a colored pixel is
- *               considered to be white(0) or black(1). The boolean
- *               interpretation of the image will be stored in
- *               image->array.
+ * Description:  Threshold the colors of the palette of a 1 or 8 bit
+ *               bmp, like the rgb values of 24 bit files, to the
+ *               table reader->palette. Indices behind the palette get
+ *               the pixel of black. If the table is black up to an
+ *               index and white afterwards (like for gray scale
+ *               palettes), this index is stored in reader->minWhite,
+ *               otherwise it is -1.
  ********************************************************************/
-static void readBmpBody(Image *image) {
-    uint32_t width = image->width;
-    uint32_t height = image->height;
-
-    uint32_t paddedWidth = roundToMultipleOf4(width * BYTES_PER_RGB_PIXEL);
-    uint32_t bmpSize = paddedWidth * height;
-    uint8_t *bmpBuffer = xmalloc(bmpSize);
-
-    // read remaining file stream to buffer after readBmpHeader
-    xfread(bmpBuffer, 1, bmpSize, image->file, "ERR: invalid BMP body information");
-
-    // calculate pixel Array
-    uint8_t *pBuffer = NULL;
-    float red, green, blue;
-
-    for (uint32_t row = 0; row < height; row++) {
-        for (uint32_t column = 0; column < width; column++) {
-            /* weight the color values of an rgb-image and determine whether
-            a pixel of the result is supposed to be black or white */
-            pBuffer = bmpBuffer + (row * paddedWidth + column * BYTES_PER_RGB_PIXEL);
-            red = *pBuffer * 0.2126;
-            green = pBuffer[1] * 0.7152;
-            blue = pBuffer[2] * 0.0722;
-            image->array[row * width + column] = (blue + green + red) > THRESHOLD ? 0 : 1;  // white = 0, black = 1
+static void readBmpPalette(BmpRows *reader, const BmpHeader *headerInformation) {
+    const uint8_t *palette = reader->fileData + SIZE_FILE_HEADER + headerInformation->infoHeaderSize;
+    int numColors = headerInformation->numColorsInPalette ? (int)headerInformation->numColorsInPalette
+                                                          : 1 << headerInformation->bitsPerPixel;
+
+    memset(reader->palette, reader->binaryPixel[0], sizeof(reader->palette));
+    thresholdBgrToPixels(palette, reader->palette, numColors, SIZE_PALETTE_ENTRY);
+
+    int minWhite = 0;
+    while (minWhite < 256 && reader->palette[minWhite]) {
+        minWhite++;
+    }
+    reader->minWhite = minWhite;
+    for (int i = minWhite; i < 256; i++) {
+        if (reader->palette[i]) {
+            reader->minWhite = -1;
+            break;
         }
     }
-    xfree(bmpBuffer);
 }
 
-void readBMP(Image *image) {
+void openBmpRows(Image *image, BmpRows *reader) {
     BmpHeader headerInformation;
 
-    readBmpHeader(image->file, &headerInformation);
-    verifyBmpHeaderInformation(&headerInformation);
+    /*  the file is mapped instead of read into a buffer, so its pixel data is thresholded right
+        from the page cache and no copy of the rgb body is needed
+    */
+    struct stat fileStat;
+    int fd = fileno(image->file);
+    if (fstat(fd, &fileStat) || fileStat.st_size < SIZE_BMP_HEADER) {
+        customExitOnFailure("ERR: read BMP header information");
+    }
+    size_t fileSize = fileStat.st_size;
+
+    uint8_t *fileData = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (fileData == MAP_FAILED) {
+        customExitOnFailure("ERR: map BMP file");
+    }
+    madvise(fileData, fileSize, MADV_SEQUENTIAL);  // only a hint, so errors don't matter
+
+    readBmpHeader(fileData, &headerInformation);
+    verifyBmpHeaderInformation(&headerInformation, fileData, fileSize);
+    int topDown = headerInformation.heightInPixel < 0;
 
     image->width = headerInformation.widthInPixel;
-    image->height = headerInformation.heightInPixel;
+    image->height = topDown ? -headerInformation.heightInPixel : headerInformation.heightInPixel;
+    image->layout = PIXEL_LAYOUT_PACKED;
+    image->array = NULL;
+    image->words = NULL;
+
+    // row 0 of the image is the bottom one, which is the last row of top-down files
+    reader->fileData = fileData;
+    reader->fileSize = fileSize;
+    reader->releasedSize = 0;
+    reader->paddedWidth = getPaddedWidth(image->width, headerInformation.bitsPerPixel);
+    reader->body = fileData + headerInformation.pixelDataOffset;
+    reader->rowOffset = reader->paddedWidth;
+    if (topDown) {
+        reader->body += (size_t)(image->height - 1) * reader->paddedWidth;
+        reader->rowOffset = -reader->rowOffset;
+    }
+    reader->bitsPerPixel = headerInformation.bitsPerPixel;
+
+    // the black and white rgb values of shares are read without thresholding each pixel
+    static const uint8_t blackAndWhite[2 * BYTES_PER_RGB_PIXEL] = {0, 0, 0, 255, 255, 255};
+    thresholdBgrToPixels(blackAndWhite, reader->binaryPixel, 2, BYTES_PER_RGB_PIXEL);
+    reader->binary = reader->bitsPerPixel == BYTES_PER_RGB_PIXEL * 8;
+
+    if (reader->bitsPerPixel <= 8) {
+        readBmpPalette(reader, &headerInformation);
+    }
+}
+
+/*********************************************************************
+ * Function:     readRgbRows
+ *--------------------------------------------------------------------
+ * Description:  Threshold the rgb values of the 24 or 32 bit bmp
+ *               rows, which start at "body", to the pixel of "rows".
+ *               Rows of pure black and white, like the ones of the
+ *               24 bit shares, take the fast path
+ *               readBinaryBgrToWords() (readBinaryBgrToPixels() for
+ *               unpacked images). After the first row with other
+ *               colors, all rows are thresholded, so colored images
+ *               aren't read twice.
+ ********************************************************************/
+static void readRgbRows(BmpRows *reader, const uint8_t *body, Image *rows) {
+    int32_t width = rows->width;
+    int bytesPerPixel = reader->bitsPerPixel / 8;
+    Pixel black = reader->binaryPixel[0];
+    Pixel white = reader->binaryPixel[1];
+
+    // calculate pixel Array straight from the mapped rows
+    for (int32_t row = 0; row < rows->height; row++) {
+        const uint8_t *bmpRow = body + row * reader->rowOffset;
+        if (rows->layout == PIXEL_LAYOUT_PACKED) {
+            uint64_t *words = rows->words + (size_t)row * rows->stride;
+            if (reader->binary) {
+                reader->binary = readBinaryBgrToWords(bmpRow, words, width, black, white);
+            }
+            if (!reader->binary) {
+                thresholdBgrToWords(bmpRow, words, width, bytesPerPixel);
+            }
+        } else {
+            Pixel *pixelRow = rows->array + (size_t)row * width;
+            if (reader->binary) {
+                reader->binary = readBinaryBgrToPixels(bmpRow, pixelRow, width, black, white);
+            }
+            if (!reader->binary) {
+                thresholdBgrToPixels(bmpRow, pixelRow, width, bytesPerPixel);
+            }
+        }
+    }
+}
+
+/*********************************************************************
+ * Function:     readPalettizedRow
+ *--------------------------------------------------------------------
+ * Description:  Copy the 1 bit bmp row "bmpRow" to the packed row
+ *               "words". The bytes of the row are gathered to words,
+ *               the order of their bits is reversed and the palette
+ *               is applied to 64 pixel at once.
+ ********************************************************************/
+static void readPalettizedRow(const BmpRows *reader, const uint8_t *bmpRow, uint64_t *words, int32_t width) {
+    int32_t stride = (width + 63) / 64;
+    uint32_t rowBytes = (width + 7) / 8;
+    uint64_t white = -(uint64_t)reader->palette[0];  // pixel of the bits 0
+    uint64_t black = -(uint64_t)reader->palette[1];  // pixel of the bits 1
+
+    // for each word of the row
+    for (int32_t word = 0; word < stride; word++) {
+        uint32_t first = 8 * word;
+        uint32_t last = rowBytes < first + 8 ? rowBytes : first + 8;
+        uint64_t bits = 0;
+        for (uint32_t i = first; i < last; i++) {
+            bits |= (uint64_t)bmpRow[i] << (8 * (i - first));
+        }
+        bits = reverseBitsInBytes(bits);
+        words[word] = (bits & black) | (~bits & white);
+    }
+    words[stride - 1] &= getRowTailMask(width);
+}
+
+/*********************************************************************
+ * Function:     readPalettizedRows
+ *--------------------------------------------------------------------
+ * Description:  Read the 1 or 8 bit bmp rows, which start at "body",
+ *               to the pixel of "rows". The indices of 8 bit rows are
+ *               compared with reader->minWhite, if the palette allows
+ *               it, otherwise they are looked up in the palette.
+ *               Byte images are unpacked row by row.
+ ********************************************************************/
+static void readPalettizedRows(const BmpRows *reader, const uint8_t *body, Image *rows) {
+    int32_t width = rows->width;
+    int32_t stride = (width + 63) / 64;
+
+    uint64_t *rowBuffer = rows->layout == PIXEL_LAYOUT_BYTE ? xmalloc(stride * sizeof(uint64_t)) : NULL;
+
+    for (int32_t row = 0; row < rows->height; row++) {
+        const uint8_t *bmpRow = body + row * reader->rowOffset;
+        uint64_t *words = rowBuffer ? rowBuffer : rows->words + (size_t)row * rows->stride;
+
+        if (reader->bitsPerPixel == 1) {
+            readPalettizedRow(reader, bmpRow, words, width);
+        } else if (reader->minWhite >= 0) {
+            thresholdGrayToWords(bmpRow, words, width, reader->minWhite);
+        } else {
+            lookupPixelsToWords(bmpRow, words, width, reader->palette);
+        }
+
+        if (rowBuffer) {
+            unpackPixelRow(rowBuffer, rows->array + (size_t)row * width, width);
+        }
+    }
+    xfree(rowBuffer);
+}
+
+/*********************************************************************
+ * Function:     releaseReadRows
+ *--------------------------------------------------------------------
+ * Description:  Drop the pages of the mapping, that were read
+ *               completely up to the row "lastRow", so the mapping
+ *               doesn't fill the memory. The rows of bottom-up files
+ *               are read from the start of the file, the ones of
+ *               top-down files from its end.
+ ********************************************************************/
+static void releaseReadRows(BmpRows *reader, const uint8_t *lastRow) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t mappingSize = (reader->fileSize + pageSize - 1) / pageSize * pageSize;
+    size_t releaseSize, releaseStart;
+
+    if (reader->rowOffset > 0) {
+        releaseSize = (size_t)(lastRow + reader->paddedWidth - reader->fileData) / pageSize * pageSize;
+        releaseStart = reader->releasedSize;
+    } else {
+        releaseSize = mappingSize - ((size_t)(lastRow - reader->fileData) + pageSize - 1) / pageSize * pageSize;
+        releaseStart = mappingSize - releaseSize;
+    }
+
+    if (releaseSize > reader->releasedSize) {
+        madvise(reader->fileData + releaseStart, releaseSize - reader->releasedSize, MADV_DONTNEED);
+        reader->releasedSize = releaseSize;
+    }
+}
+
+void readBmpRows(BmpRows *reader, Image *rows, int32_t firstRow) {
+    const uint8_t *body = reader->body + firstRow * reader->rowOffset;
+
+    if (reader->bitsPerPixel <= 8) {
+        readPalettizedRows(reader, body, rows);
+    } else {
+        readRgbRows(reader, body, rows);
+    }
+
+    releaseReadRows(reader, body + (rows->height - 1) * reader->rowOffset);
+}
+
+void closeBmpRows(BmpRows *reader) {
+    munmap(reader->fileData, reader->fileSize);
+    reader->fileData = NULL;
+}
+
+void readBMP(Image *image) {
+    BmpRows reader;
 
+    openBmpRows(image, &reader);
     mallocPixelArray(image);
-    readBmpBody(image);
+    readBmpRows(&reader, image, 0);
+    closeBmpRows(&reader);
 }
@@ -6,8 +6,24 @@
 #ifndef HANDLEBMP_H
 #define HANDLEBMP_H
 
+#include <stddef.h>
+
 #include "image.h"
 
+typedef struct {
+    uint8_t *fileData;      // the mapped bmp file
+    size_t fileSize;        // size of the mapping in bytes
+    size_t releasedSize;    // the pages of the first (top-down: last) "releasedSize" bytes are already dropped
+    const uint8_t *body;    // row 0 of the image, which is the bottom row
+    ptrdiff_t rowOffset;    // bytes from a row of the image to the next one, negative for top-down files
+    size_t paddedWidth;     // number of bytes per row of the pixel data
+    uint16_t bitsPerPixel;  // 1 or 8 (palette), 24 or 32 (rgb values)
+    Pixel palette[256];     // pixel value of the palette entries of 1 and 8 bit files
+    int minWhite;           // 8 bit files: first white palette index, if all after it are white, else -1
+    Pixel binaryPixel[2];   // pixel value of black and white in 24 bit files
+    int binary;             // 0 after a 24 bit row with other colors than black and white was read
+} BmpRows;
+
 /*********************************************************************
  * Function:     createBMP
  *--------------------------------------------------------------------
@@ -15,18 +31,75 @@
  *               bmp file from the pure pixel data of a boolean array,
  *               stored in image->array. It will fill the empty bmp
  *               file opened in image->file with a valid bmp header
- *               and the array contents, restructured as rgb-values.
+ *               and the array contents, restructured as rgb-values or
+ *               palette indices (see BMP_BITS_PER_PIXEL).
  ********************************************************************/
 void createBMP(Image *image);
 
+/*********************************************************************
+ * Function:     startBMP
+ *--------------------------------------------------------------------
+ * Description:  Write the bmp header of an image with the width and
+ *               height of "image" to the empty file image->file.
+ *               The rows have to be appended with appendBmpRows()
+ *               afterwards, in the order of the file (bottom-up).
+ *               This way, images can be written without holding all
+ *               of their pixel in memory.
+ ********************************************************************/
+void startBMP(Image *image);
+
+/*********************************************************************
+ * Function:     appendBmpRows
+ *--------------------------------------------------------------------
+ * Description:  Append all rows of "rows", which must be as wide as
+ *               "image", as rgb-values or palette indices to
+ *               image->file, that was started with startBMP().
+ ********************************************************************/
+void appendBmpRows(Image *image, const Image *rows);
+
 /*********************************************************************
  * Function:     readBMP
  *--------------------------------------------------------------------
- * Description:  The function readBMP will read a colored bmp opened
- *               in image->file and get the information: width, height
- *               and the pixel data from it, to store them into
- *               the image structure "image".
+ * Description:  The function readBMP will read a colored (24 or 32
+ *               bit) or palettized (1 or 8 bit) bmp opened in
+ *               image->file and get the information: width, height
+ *               and the pixel data from it, to store them bit-packed
+ *               (PIXEL_LAYOUT_PACKED) into the image structure
+ *               "image". The rows of 1 bit files are copied as they
+ *               are, only their palette is applied. Row 0 of the image
+ *               is the bottom row, also for top-down files.
  ********************************************************************/
 void readBMP(Image *image);
 
+/*********************************************************************
+ * Function:     openBmpRows
+ *--------------------------------------------------------------------
+ * Description:  Map the bmp opened in image->file and store its width
+ *               and height in "image", without reading its pixel.
+ *               The rows can be read afterwards with readBmpRows(),
+ *               so images larger than the memory can be processed
+ *               band by band. "reader" has to be closed with
+ *               closeBmpRows().
+ ********************************************************************/
+void openBmpRows(Image *image, BmpRows *reader);
+
+/*********************************************************************
+ * Function:     readBmpRows
+ *--------------------------------------------------------------------
+ * Description:  Read the rows firstRow to firstRow+rows->height-1 of
+ *               the bmp opened by openBmpRows() into the pixel array
+ *               of "rows", which must be as wide as the bmp. The rows
+ *               have to be read in increasing order: the pages of the
+ *               mapping before the last read row are dropped, so the
+ *               memory needed doesn't grow with the image.
+ ********************************************************************/
+void readBmpRows(BmpRows *reader, Image *rows, int32_t firstRow);
+
+/*********************************************************************
+ * Function:     closeBmpRows
+ *--------------------------------------------------------------------
+ * Description:  Unmap the bmp opened by openBmpRows().
+ ********************************************************************/
+void closeBmpRows(BmpRows *reader);
+
 #endif /* HANDLEBMP_H */
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "fileManagement.h"
 #include "handleBMP.h"
 #include "settings.h"
+#include "simdKernels.h"
 
 // note: sourcePath and sharePath are globals from visualCrypt.c
 
@@ -34,6 +35,24 @@ static inline void openImageW(char *path, Image *image) {
     image->file = xfopen(path, "wb");
 }
 
+SIMD_KERNEL void packPixelRow(const Pixel *source, uint64_t *destination, int width) {
+    int numWords = (width + 63) / 64;
+    for (int word = 0; word < numWords; word++) {
+        int count = width - word * 64 < 64 ? width - word * 64 : 64;
+        uint64_t bits = 0;
+        for (int bit = 0; bit < count; bit++) {
+            bits |= (uint64_t)(source[word * 64 + bit] & 1) << bit;
+        }
+        destination[word] = bits;
+    }
+}
+
+SIMD_KERNEL void unpackPixelRow(const uint64_t *source, Pixel *destination, int width) {
+    for (int column = 0; column < width; column++) {
+        destination[column] = (source[column >> 6] >> (column & 63)) & 1;
+    }
+}
+
 void createSourceImage(Image *image) {
     openImageR(sourcePath, image);
     readBMP(image);
@@ -18,11 +18,19 @@ typedef uint8_t Pixel;  // black / white
 
 #endif  // TYPE_PIXEL
 
+typedef enum {
+    PIXEL_LAYOUT_BYTE,   // one Pixel per byte in image->array
+    PIXEL_LAYOUT_PACKED  // 64 pixel per word in image->words
+} PixelLayout;
+
 typedef struct {
     FILE *file;
     Pixel *array;
+    uint64_t *words;  // pixel (row, column) is bit (column % 64) of words[row * stride + column / 64]
     int32_t width;
     int32_t height;
+    int32_t stride;  // number of words per row
+    PixelLayout layout;
 } Image;
 
 extern char *sourcePath;
@@ -33,11 +41,63 @@ extern char *sharePath;
  *--------------------------------------------------------------------
  * Description:  Allocates a pixel array of the size image->width
  *               * image->height and stores it in image->array.
+ *               If image->layout is PIXEL_LAYOUT_PACKED, the pixel
+ *               are stored bitwise in image->words instead, which
+ *               needs only an eighth of the memory. Unused bits at
+ *               the end of each row are zero.
  ********************************************************************/
 static inline void mallocPixelArray(Image *image) {
-    image->array = xmalloc(image->width * image->height);
+    if (image->layout == PIXEL_LAYOUT_PACKED) {
+        image->stride = (image->width + 63) / 64;
+        image->words = xcalloc((size_t)image->stride * image->height, sizeof(uint64_t));
+        image->array = NULL;
+    } else {
+        image->stride = 0;
+        image->words = NULL;
+        image->array = xmalloc((size_t)image->width * image->height);
+    }
+}
+
+/*********************************************************************
+ * Function:     getRowTailMask
+ *--------------------------------------------------------------------
+ * Description:  Return the mask of the used bits in the last word of
+ *               a packed row with "width" pixel. Kernels that write
+ *               whole words apply it to keep the unused bits zero.
+ ********************************************************************/
+static inline uint64_t getRowTailMask(int width) {
+    return width % 64 ? ((uint64_t)1 << (width % 64)) - 1 : ~(uint64_t)0;
 }
 
+/*********************************************************************
+ * Function:     getImagePixel
+ *--------------------------------------------------------------------
+ * Description:  Return the value of the pixel at "row" and "column"
+ *               of an image in either layout.
+ ********************************************************************/
+static inline Pixel getImagePixel(const Image *image, int row, int column) {
+    if (image->layout == PIXEL_LAYOUT_PACKED) {
+        return (image->words[row * image->stride + (column >> 6)] >> (column & 63)) & 1;
+    }
+    return image->array[row * image->width + column];
+}
+
+/*********************************************************************
+ * Function:     packPixelRow
+ *--------------------------------------------------------------------
+ * Description:  Pack "width" pixel of one byte each from "source"
+ *               into the words of "destination", 64 pixel per word.
+ ********************************************************************/
+void packPixelRow(const Pixel *source, uint64_t *destination, int width);
+
+/*********************************************************************
+ * Function:     unpackPixelRow
+ *--------------------------------------------------------------------
+ * Description:  Unpack "width" pixel from the words of "source"
+ *               to one byte per pixel in "destination".
+ ********************************************************************/
+void unpackPixelRow(const uint64_t *source, Pixel *destination, int width);
+
 /*********************************************************************
  * Function:     createSourceImage
  *--------------------------------------------------------------------
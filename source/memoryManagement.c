@@ -26,6 +26,15 @@ void *xcalloc(size_t nitems, size_t size) {
     return newMem->data;
 }
 
+void *xaligned_alloc(size_t alignment, size_t size) {
+    List *newMem = malloc(sizeof(List));
+    validatePointer(newMem, "ERR: allocate memory");
+    newMem->data = aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    validatePointer(newMem->data, "ERR: allocate memory");
+    appendOnList(newMem, &memList);
+    return newMem->data;
+}
+
 void xfree(void *ptr) {
     if (!ptr) {
         return;
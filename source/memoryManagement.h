@@ -37,6 +37,21 @@ void *xmalloc(size_t size);
  ********************************************************************/
 void *xcalloc(size_t nitems, size_t size);
 
+/*********************************************************************
+ * Function:     xaligned_alloc
+ *--------------------------------------------------------------------
+ * Description:  Calls aligned_alloc, but also creates a list entry
+ *               for the global memory list.
+ *               The size is rounded up to a multiple of "alignment".
+ *               If the allocation fails, the program will free the
+ *               allocated memory, close all opened files and abort.
+ * Input:        alignment = alignment of the memory block in bytes
+ *               (must be a power of two),
+ *               size = size of the memory block in bytes
+ * Return:       pointer to the new allocated memory
+ ********************************************************************/
+void *xaligned_alloc(size_t alignment, size_t size);
+
 /*********************************************************************
  * Function:     xfree
  *--------------------------------------------------------------------
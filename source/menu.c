@@ -5,10 +5,13 @@
 
 #include "menu.h"
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "settings.h"
+
 /*********************************************************************
  * Function:     clearBuffer
  *--------------------------------------------------------------------
@@ -42,9 +45,12 @@ int getNumber(const char *prompt, int min, int max, int *result) {
 
 int getNfromUser() {
     int valid = 0, n;
+    char prompt[50];
+    memset(prompt, '\0', sizeof(prompt));
+    snprintf(prompt, sizeof(prompt), "Enter number of shares:\n<min> = 2\n<max> = %d\n", MAX_NUMBER_OF_SHARES);
     do {
         clear();
-        valid = getNumber("Enter number of shares:\n<min> = 2\n<max> = 8\n", 2, 8, &n);
+        valid = getNumber(prompt, 2, MAX_NUMBER_OF_SHARES, &n);
     } while (!valid);
 
     return n;
@@ -82,3 +88,13 @@ int getMenu(const char *title, char **menuItem, int numChoices, const char *prom
 
     return choice;
 }
+
+void printVerbose(const char *format, ...) {
+    if (!verbose) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stdout, format, args);
+    va_end(args);
+}
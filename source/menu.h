@@ -8,6 +8,8 @@
 
 #define clear() fprintf(stdout, "\033[H\033[J")
 
+extern int verbose;
+
 /*********************************************************************
  * Function:     getNumber
  *--------------------------------------------------------------------
@@ -49,4 +51,12 @@ int getKfromUser(int n);
  ********************************************************************/
 int getMenu(const char *title, char **menuItem, int numChoices, const char *prompt);
 
+/*********************************************************************
+ * Function:     printVerbose
+ *--------------------------------------------------------------------
+ * Description:  Print like printf to stdout, but only if the program
+ *               was called with the verbose option (global "verbose").
+ ********************************************************************/
+void printVerbose(const char *format, ...);
+
 #endif
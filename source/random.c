@@ -5,60 +5,307 @@
 
 #include "random.h"
 
+#include <sys/random.h>
+
+#include "chacha20.h"
 #include "fileManagement.h"
 #include "memoryManagement.h"
+#include "settings.h"
+
+#define RANDOM_POOL_ALIGNMENT 64    // cache line size
+#define SEEDED_POOL_SIZE      4096  // after a seek, often only a few bytes of a refill are used
 
-#define MAX_UINT -1
+__extension__ typedef unsigned __int128 uint128_t;
 
-uint8_t getRandomNumber(FILE *randomSrc, uint8_t min, uint8_t max) {
-    uint8_t randNum, inRangeNum, limit = MAX_UINT - max;
+/*********************************************************************
+ * Function:     readRandomFile
+ *--------------------------------------------------------------------
+ * Description:  Fill function of the file source: read "size" bytes
+ *               of the opened random file.
+ ********************************************************************/
+static void readRandomFile(void *file, uint8_t *buffer, size_t size) {
+    xfread(buffer, 1, size, file, "ERR: read file with random numbers");
+}
 
-    do {
-        xfread(&randNum, sizeof(randNum), 1, randomSrc, "ERR: read file with random numbers");
-        inRangeNum = min + (randNum % max);
-    } while (randNum - inRangeNum > limit);  // remove bias
+/*********************************************************************
+ * Function:     openRandomFile
+ *--------------------------------------------------------------------
+ * Description:  Creates a random source, which reads its random
+ *               numbers directly from RANDOM_FILE_PATH.
+ ********************************************************************/
+static RandomSource openRandomFile() {
+    FILE *file = xfopen(RANDOM_FILE_PATH, "r");
+    setvbuf(file, NULL, _IONBF, 0);  // the pool itself is the buffer
 
-    return inRangeNum;
+    RandomSource source = {.name = "file " RANDOM_FILE_PATH, .fill = readRandomFile, .seek = NULL, .state = file};
+    return source;
 }
 
-int *createSetOfN(int n, int start) {
-    int *setOfN = xmalloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) {
-        setOfN[i] = i + start;
+/*********************************************************************
+ * Function:     getKernelRandomBytes
+ *--------------------------------------------------------------------
+ * Description:  Fill "buffer" with random bytes of the kernel, by
+ *               calling getrandom(2). If the system call isn't
+ *               available, they are read from RANDOM_FILE_PATH.
+ ********************************************************************/
+static void getKernelRandomBytes(uint8_t *buffer, size_t size) {
+    size_t received = 0;
+    while (received < size) {
+        ssize_t ret = getrandom(buffer + received, size - received, 0);
+        if (ret < 0) {
+            break;
+        }
+        received += ret;
     }
-    return setOfN;
+
+    if (received < size) {
+        FILE *file = xfopen(RANDOM_FILE_PATH, "r");
+        xfread(buffer + received, 1, size - received, file, "ERR: read file with random numbers");
+        xfclose(file);
+    }
+}
+
+/*********************************************************************
+ * Function:     generateKeystream
+ *--------------------------------------------------------------------
+ * Description:  Fill function of the ChaCha20 source: the random
+ *               bytes are the next bytes of the keystream.
+ ********************************************************************/
+static void generateKeystream(void *cipher, uint8_t *buffer, size_t size) {
+    generateChaCha20(cipher, buffer, size);
 }
 
-void shuffleVector(int *vector, int n, FILE *randomSrc) {
-    int tmp, randNum;
-    for (int i = n - 1; i > 0; i--) {
-        randNum = getRandomNumber(randomSrc, 0, i + 1);
+/*********************************************************************
+ * Function:     createChaCha20Source
+ *--------------------------------------------------------------------
+ * Description:  Creates a random source, which generates its random
+ *               numbers as ChaCha20 keystream in userspace. The key
+ *               is taken once from the kernel.
+ ********************************************************************/
+static RandomSource createChaCha20Source() {
+    uint8_t key[CHACHA20_KEY_SIZE];
+    getKernelRandomBytes(key, sizeof(key));
+
+    ChaCha20 *cipher = xmalloc(sizeof(ChaCha20));
+    initChaCha20(cipher, key, 0, 0);
+    explicit_bzero(key, sizeof(key));
+
+    RandomSource source = {.name = "ChaCha20", .fill = generateKeystream, .seek = NULL, .state = cipher};
+    return source;
+}
 
-        // swap elements
-        tmp = vector[i];
-        vector[i] = vector[randNum];
-        vector[randNum] = tmp;
+/*********************************************************************
+ * Function:     seekKeystream
+ *--------------------------------------------------------------------
+ * Description:  Seek function of the seeded source: the stream is
+ *               used as nonce of the cipher, and each position gets
+ *               2^32 keystream blocks of its own.
+ ********************************************************************/
+static void seekKeystream(void *cipher, uint64_t stream, uint64_t position) {
+    ChaCha20 *_cipher = cipher;
+    _cipher->nonce = stream;
+    _cipher->counter = position << 32;
+}
+
+/*********************************************************************
+ * Function:     createSeededSource
+ *--------------------------------------------------------------------
+ * Description:  Creates a random source, which generates the ChaCha20
+ *               keystream of a key built from "seed". The keystream
+ *               is a counter based generator: every (stream, position)
+ *               pair can be reached directly by seekKeystream().
+ ********************************************************************/
+static RandomSource createSeededSource(uint64_t seed) {
+    uint8_t key[CHACHA20_KEY_SIZE] = {0};
+    for (int i = 0; i < 8; i++) {
+        key[i] = seed >> (8 * i);
     }
+
+    ChaCha20 *cipher = xmalloc(sizeof(ChaCha20));
+    initChaCha20(cipher, key, 0, 0);
+
+    RandomSource source = {
+        .name = "ChaCha20 (seeded)", .fill = generateKeystream, .seek = seekKeystream, .state = cipher};
+    return source;
+}
+
+/*********************************************************************
+ * Function:     fillBackBuffer
+ *--------------------------------------------------------------------
+ * Description:  Thread function, which fills the back buffer of a
+ *               double buffered random pool.
+ ********************************************************************/
+static void *fillBackBuffer(void *randomPool) {
+    RandomPool *pool = randomPool;
+    pool->source.fill(pool->source.state, pool->backBuffer, pool->size);
+    return NULL;
 }
 
 /*********************************************************************
- * Function:     copyMatrixColumn
+ * Function:     startBackgroundRefill
  *--------------------------------------------------------------------
- * Description:  Copy the matrix column of column number "srcIdx"
- *               from "src" to column "destIdx" of "dest".
+ * Description:  Start a thread, which fills the back buffer of the
+ *               pool while the front buffer is in use.
  ********************************************************************/
-static void copyMatrixColumn(BooleanMatrix *dest, BooleanMatrix *src, int destIdx, int srcIdx) {
-    int numRows = src->height;
-    for (int row = 0; row < numRows; row++) {
-        setPixel(*dest, row, destIdx, getPixel(*src, row, srcIdx));
+static inline void startBackgroundRefill(RandomPool *pool) {
+    if (pthread_create(&pool->refillThread, NULL, fillBackBuffer, pool)) {
+        customExitOnFailure("ERR: start thread to refill random pool");
+    }
+}
+
+RandomPool *createRandomPool() {
+    RandomPool *pool = xmalloc(sizeof(RandomPool));
+    pool->size = RANDOM_POOL_SIZE;
+    pool->doubleBuffered = RANDOM_POOL_DOUBLE_BUFFERED;
+
+    if (useRandomSeed) {
+        pool->source = createSeededSource(randomSeed);
+        // a background refill would run ahead of the next seek
+        pool->doubleBuffered = 0;
+        if (SEEDED_POOL_SIZE < pool->size) {
+            pool->size = SEEDED_POOL_SIZE;
+        }
+    } else if (RANDOM_SOURCE == RANDOM_SOURCE_CHACHA20) {
+        pool->source = createChaCha20Source();
+    } else {
+        pool->source = openRandomFile();
+    }
+
+    pool->buffer = xaligned_alloc(RANDOM_POOL_ALIGNMENT, pool->size);
+    pool->backBuffer = NULL;
+    pool->bitReservoir = 0;
+    pool->reservoirBits = 0;
+
+    pool->source.fill(pool->source.state, pool->buffer, pool->size);
+    pool->position = 0;
+
+    if (pool->doubleBuffered) {
+        pool->backBuffer = xaligned_alloc(RANDOM_POOL_ALIGNMENT, pool->size);
+        startBackgroundRefill(pool);
+    }
+    return pool;
+}
+
+void closeRandomPool(RandomPool *pool) {
+    if (pool->doubleBuffered) {
+        pthread_join(pool->refillThread, NULL);
+        pool->doubleBuffered = 0;
+    }
+}
+
+void refillRandomPool(RandomPool *pool) {
+    if (pool->doubleBuffered) {
+        pthread_join(pool->refillThread, NULL);
+
+        uint8_t *tmp = pool->buffer;
+        pool->buffer = pool->backBuffer;
+        pool->backBuffer = tmp;
+
+        startBackgroundRefill(pool);
+    } else {
+        pool->source.fill(pool->source.state, pool->buffer, pool->size);
+    }
+    pool->position = 0;
+}
+
+void seekRandomPool(RandomPool *pool, uint64_t stream, uint64_t position) {
+    if (!pool->source.seek) {
+        return;
+    }
+
+    pool->source.seek(pool->source.state, stream, position);
+
+    // drop all random numbers of the previous position
+    pool->position = pool->size;
+    pool->bitReservoir = 0;
+    pool->reservoirBits = 0;
+}
+
+void getRandomWords(RandomPool *pool, uint64_t *dest, size_t count) {
+    size_t size = count * sizeof(uint64_t);
+    uint8_t *destBytes = (uint8_t *)dest;
+
+    while (size) {
+        if (pool->size - pool->position < sizeof(uint64_t)) {
+            refillRandomPool(pool);
+        }
+        // only whole words are taken from the pool, like in getRandomWord()
+        size_t available = (pool->size - pool->position) & ~(sizeof(uint64_t) - 1);
+        size_t chunk = size < available ? size : available;
+        memcpy(destBytes, pool->buffer + pool->position, chunk);
+        pool->position += chunk;
+        destBytes += chunk;
+        size -= chunk;
     }
 }
 
-void shuffleColumns(BooleanMatrix *dest, BooleanMatrix *src, FILE *randomSrc, int *indices) {
-    int numColumns = src->width;
-    shuffleVector(indices, numColumns, randomSrc);
+uint64_t getRandomBounded(RandomPool *pool, uint64_t bound) {
+    uint128_t product = (uint128_t)getRandomWord(pool) * bound;
+    uint64_t low = (uint64_t)product;
+
+    if (low < bound) {
+        uint64_t threshold = -bound % bound;  // = 2^64 mod bound
+        while (low < threshold) {
+            product = (uint128_t)getRandomWord(pool) * bound;
+            low = (uint64_t)product;
+        }
+    }
+    return product >> 64;
+}
+
+void shuffleVector(int *vector, int n, RandomPool *randomSrc) {
+    int tmp, randIdx, i = n - 1;
+    while (i > 0) {
+        // combine the ranges of the next indices, as long as their product fits in 64 bit
+        uint64_t bound = i + 1;
+        int j = i - 1;
+        while (j > 0 && !((uint128_t)bound * (uint64_t)(j + 1) >> 64)) {
+            bound *= j + 1;
+            j--;
+        }
+
+        /*  the high word of randNum * (i + 1) is the random index, the low word is the random number
+            for the next index, so no division is needed. The low word after the whole batch equals
+            randNum * bound (mod 2^64), which is rejected like in getRandomBounded() to avoid bias.
+        */
+        uint64_t randNum = getRandomWord(randomSrc);
+        if (randNum * bound < bound) {
+            uint64_t threshold = -bound % bound;  // = 2^64 mod bound
+            while (randNum * bound < threshold) {
+                randNum = getRandomWord(randomSrc);
+            }
+        }
+        for (; i > j; i--) {
+            uint128_t product = (uint128_t)randNum * (uint64_t)(i + 1);
+            randIdx = product >> 64;
+            randNum = (uint64_t)product;
+
+            // swap elements
+            tmp = vector[i];
+            vector[i] = vector[randIdx];
+            vector[randIdx] = tmp;
+        }
+    }
+}
+
+SubsetTable createSubsetTable(int n, int k) {
+    SubsetTable table = {.n = n, .k = k, .count = 1, .masks = NULL};
+
+    // C(n,k) = n/1 * (n-1)/2 * ... * (n-k+1)/k, every partial product is a binomial coefficient
+    for (int i = 1; i <= k; i++) {
+        table.count = table.count * (n - k + i) / i;
+    }
+    table.masks = xmalloc(table.count * sizeof(int));
 
-    for (int i = 0; i < numColumns; i++) {
-        copyMatrixColumn(dest, src, i, indices[i]);
+    /*  Gosper's hack: the next larger number with k set bits is found by moving the lowest
+        block of ones one position up and its remaining ones back to the bottom
+    */
+    int mask = (1 << k) - 1;
+    for (uint32_t idx = 0; idx < table.count; idx++) {
+        table.masks[idx] = mask;
+        int lowest = mask & -mask;
+        int ripple = mask + lowest;
+        mask = ripple | (((mask ^ ripple) >> 2) / lowest);
     }
+    return table;
 }
@@ -6,8 +6,10 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "booleanMatrix.h"
 
@@ -18,21 +20,152 @@ typedef uint8_t Pixel;  // black / white
 
 #endif  // TYPE_PIXEL
 
+typedef struct {
+    const char *name;
+    void (*fill)(void *state, uint8_t *buffer, size_t size);  // writes "size" random bytes to "buffer"
+    void (*seek)(void *state, uint64_t stream, uint64_t position);  // NULL, if the source can't be positioned
+    void *state;  // i.e. an opened file or a ChaCha20 cipher
+} RandomSource;
+
+typedef struct {
+    RandomSource source;
+    uint8_t *buffer;      // random bytes, which are handed out by the draw functions
+    uint8_t *backBuffer;  // refilled in the background, if double buffering is enabled
+    size_t size;
+    size_t position;
+    uint64_t bitReservoir;  // random bits left over from previous calls of getRandomBits
+    int reservoirBits;      // number of valid bits in bitReservoir
+    pthread_t refillThread;
+    int doubleBuffered;
+} RandomPool;
+
+typedef struct {
+    int n;
+    int k;
+    uint32_t count;  // C(n,k) subsets are stored in the table
+    int *masks;      // bit i of a mask is set, if i is part of the subset
+} SubsetTable;
+
+extern uint64_t randomSeed;
+extern int useRandomSeed;
+
 /*********************************************************************
- * Function:     getRandomNumber
+ * Function:     createRandomPool
  *--------------------------------------------------------------------
- * Description:  Return a random number between [min, max), generated
- *               from a file containing random numbers.
- *               To avoid bias, the "java algorithm" is used.
+ * Description:  Creates the random source chosen by RANDOM_SOURCE and
+ *               allocates an aligned buffer of RANDOM_POOL_SIZE bytes,
+ *               which will be filled in bulk from the source. If
+ *               RANDOM_POOL_DOUBLE_BUFFERED is set, a second buffer
+ *               is refilled by a background thread while the first
+ *               one is used.
+ *               If the global "useRandomSeed" is set, the source is a
+ *               ChaCha20 keystream keyed with "randomSeed" instead,
+ *               which can be positioned with seekRandomPool().
+ * Return:       The created RandomPool.
  ********************************************************************/
-uint8_t getRandomNumber(FILE *randomSrc, uint8_t min, uint8_t max);
+RandomPool *createRandomPool();
 
 /*********************************************************************
- * Function:     createSetOfN
+ * Function:     closeRandomPool
  *--------------------------------------------------------------------
- * Description:  Create vector containing values from "start" to "n".
+ * Description:  Waits for a running background refill to finish.
+ *               Must be called before the buffers of the pool are
+ *               freed by xfreeAll.
  ********************************************************************/
-int *createSetOfN(int n, int start);
+void closeRandomPool(RandomPool *pool);
+
+/*********************************************************************
+ * Function:     refillRandomPool
+ *--------------------------------------------------------------------
+ * Description:  Fills the buffer of the pool with new random bytes
+ *               and resets the read position to its start.
+ ********************************************************************/
+void refillRandomPool(RandomPool *pool);
+
+/*********************************************************************
+ * Function:     seekRandomPool
+ *--------------------------------------------------------------------
+ * Description:  In seeded mode, all following random numbers are
+ *               taken from the substream "position" of the stream
+ *               "stream", which only depends on the seed. This way
+ *               every part of an image, that starts with a seek, gets
+ *               the same random numbers, independent of the order in
+ *               which the parts are calculated.
+ *               The algorithms seek at the start of each source row
+ *               (position = row number). Algorithms that fill the
+ *               shares in several passes use a different stream for
+ *               each pass.
+ *               Without a seed, this function does nothing.
+ ********************************************************************/
+void seekRandomPool(RandomPool *pool, uint64_t stream, uint64_t position);
+
+/*********************************************************************
+ * Function:     getRandomWord
+ *--------------------------------------------------------------------
+ * Description:  Return the next 64 random bits of the pool. The pool
+ *               is refilled, when less than 8 bytes are left.
+ ********************************************************************/
+static inline uint64_t getRandomWord(RandomPool *pool) {
+    uint64_t word;
+    if (pool->size - pool->position < sizeof(word)) {
+        refillRandomPool(pool);
+    }
+    memcpy(&word, pool->buffer + pool->position, sizeof(word));
+    pool->position += sizeof(word);
+    return word;
+}
+
+/*********************************************************************
+ * Function:     getRandomWords
+ *--------------------------------------------------------------------
+ * Description:  Copy "count" random words of 64 bit from the pool to
+ *               "dest", refilling it as often as needed.
+ ********************************************************************/
+void getRandomWords(RandomPool *pool, uint64_t *dest, size_t count);
+
+/*********************************************************************
+ * Function:     getRandomBits
+ *--------------------------------------------------------------------
+ * Description:  Return "numBits" random bits (i.e. one per share),
+ *               stored in the lowest bits of the result.
+ *               The bits are taken from a 64 bit reservoir of the
+ *               pool, so no random bits are wasted, if only a few of
+ *               them are needed at once. Bits left in the reservoir
+ *               are kept for the next call.
+ * Input:        numBits = number of random bits between 1 and 64
+ ********************************************************************/
+static inline uint64_t getRandomBits(RandomPool *pool, int numBits) {
+    if (numBits == 64) {
+        return getRandomWord(pool);
+    }
+
+    uint64_t bits, mask = (UINT64_C(1) << numBits) - 1;
+    if (pool->reservoirBits >= numBits) {
+        bits = pool->bitReservoir;
+        pool->bitReservoir >>= numBits;
+        pool->reservoirBits -= numBits;
+    } else {
+        // use the remaining bits and take the missing ones from a new word
+        uint64_t word = getRandomWord(pool);
+        int missingBits = numBits - pool->reservoirBits;
+        bits = pool->bitReservoir | (word << pool->reservoirBits);
+        pool->bitReservoir = word >> missingBits;
+        pool->reservoirBits = 64 - missingBits;
+    }
+    return bits & mask;
+}
+
+/*********************************************************************
+ * Function:     getRandomBounded
+ *--------------------------------------------------------------------
+ * Description:  Return a random number between [0, bound), generated
+ *               from 64 random bits of the pool.
+ *               To avoid bias, Lemire's nearly divisionless method is
+ *               used: a new word is only needed, if the first one
+ *               falls into the small biased range, whose probability
+ *               is bound / 2^64.
+ ********************************************************************/
+uint64_t getRandomBounded(RandomPool *pool, uint64_t bound);
 
 /*********************************************************************
  * Function:     shuffleVector
@@ -40,19 +173,33 @@ int *createSetOfN(int n, int start);
  * Description:  The function shuffleVector() shifts the vector
  *               elements randomly to a different place.
  *               The Fisher-Yates shuffle algorithm is used for this
- *               purpose.
+ *               purpose. Its random indices are not drawn one by one:
+ *               as many as fit into 64 bit are taken from a single
+ *               random word by repeated multiplication with their
+ *               range, so n=8 needs one draw and n=128 only 12.
  * Input:        n = number of elements / size of the vector
- *               randomSrc = file with random numbers
+ *               randomSrc = pool of random numbers
  * In/Out:       vector = the vector, which elements will be shifted
  ********************************************************************/
-void shuffleVector(int *vector, int n, FILE *randomSrc);
+void shuffleVector(int *vector, int n, RandomPool *randomSrc);
+
+/*********************************************************************
+ * Function:     createSubsetTable
+ *--------------------------------------------------------------------
+ * Description:  Creates a table containing all C(n,k) subsets of the
+ *               numbers 0 to n-1 with k elements, as n-bit masks in
+ *               increasing order (C(16,8) = 12870 masks at most).
+ ********************************************************************/
+SubsetTable createSubsetTable(int n, int k);
 
 /*********************************************************************
- * Function:     shuffleColumns
+ * Function:     getRandomSubset
  *--------------------------------------------------------------------
- * Description:  Copy matrix from "src" to "dest" in a column-shuffled
- *               way, by getting shuffled numbers from "indices".
+ * Description:  Return the mask of a random subset of the table, by
+ *               choosing one entry with a single bounded draw.
  ********************************************************************/
-void shuffleColumns(BooleanMatrix *dest, BooleanMatrix *src, FILE *randomSrc, int *indices);
+static inline int getRandomSubset(SubsetTable *table, RandomPool *randomSrc) {
+    return table->masks[getRandomBounded(randomSrc, table->count)];
+}
 
 #endif /* RANDOM_H */
@@ -11,55 +11,128 @@
 /*  SOURCE_PATH = the secret image.
     SHARE_PATH = directory where the shares and decryptions of the shares will be stored.
     TIME_LOG_PATH = the log file of the time measurement.
+    BASIS_STORE_PATH = directory where the basis matrices of the deterministic algorithm
+    are stored for the next program runs.
 
     The paths must be relative to the program location.
 
     Note: Used in visualCrypt.c
 */
-#define SOURCE_PATH   "../image/cameraman.bmp"
-#define SHARE_PATH    "../image"
-#define TIME_LOG_PATH "../timeMeasurement.log"
+#define SOURCE_PATH      "../image/cameraman.bmp"
+#define SHARE_PATH       "../image"
+#define TIME_LOG_PATH    "../timeMeasurement.log"
+#define BASIS_STORE_PATH "../basis"
 
 /*  RANDOM_FILE_PATH = the file used as source to get random numbers
 
     /dev/urandom is faster to get numbers from
     /dev/random should be used to generate "secure shares"
 
-    Note: Used in vcAlgorithms.c and timeMeasurement.c
+    Note: Used in random.c
 */
 #define RANDOM_FILE_PATH "/dev/urandom"
 
+/*  RANDOM_SOURCE = the generator, which fills the random pool
+
+    RANDOM_SOURCE_FILE = all random numbers are read from RANDOM_FILE_PATH
+    RANDOM_SOURCE_CHACHA20 = the random numbers are the keystream of the ChaCha20 cipher,
+    which is generated in userspace. Its key is taken once from the kernel (getrandom(2),
+    or RANDOM_FILE_PATH if the system call is not available).
+
+    Note: Used in random.c
+*/
+#define RANDOM_SOURCE_FILE     0
+#define RANDOM_SOURCE_CHACHA20 1
+#define RANDOM_SOURCE          RANDOM_SOURCE_CHACHA20
+
+/*  RANDOM_POOL_SIZE = number of bytes, which are taken at once from RANDOM_SOURCE into the
+    random pool. Every random number is taken from this buffer, so the source is only accessed
+    when all bytes of the pool have been used.
+    RANDOM_POOL_DOUBLE_BUFFERED = if non-zero, a second buffer of the same size is filled by
+    a background thread, while the random numbers of the first one are used.
+
+    Note: Used in random.c
+*/
+#define RANDOM_POOL_SIZE            (1 << 20)
+#define RANDOM_POOL_DOUBLE_BUFFERED 0
+
 /* ADJUSTMENTS */
 
 /*  Threshold:
     Color level to decide whether a pixel of the secret image is considered black or white.
     Small numbers will cause a brighter result image, when the shares are stacked together,
     and high numbers vice versa a dark result image.
+    A pixel is white, if its luminance 0.2126 red + 0.7152 green + 0.0722 blue, rounded half up
+    to an integer, is greater than the threshold.
     Min: 0, Max: 255
     (Values out of range will have the same result as Min and Max: An all-white or all-black
     result image.)
 
-    Note: Used in handleBMP.c
+    Note: Used in simdKernels.c
 */
 #define THRESHOLD 127
 
-/*  Print Sets and Basis Matrices:
-    If this Option is non-zero, the program will print the calculated sets, subsets and
-    basis matrices, when either the deterministic or probabilistic algorithm is called.
+/*  BMP Output Format:
+    Bits per pixel of the written shares and decrypted images. Both formats can be read back
+    to decrypt the shares.
+
+    1 = two color palette (white, black), one bit per pixel: 24 times smaller files
+    24 = rgb values, three equal color bytes per pixel
 
-    Note: Used in booleanMatrix.c
+    Note: Used in handleBMP.c
 */
-#define PRINT_SETS_AND_BASIS_MATRICES 0
+#define BMP_BITS_PER_PIXEL 1
 
-/*  Random Grid Algorithms:
-    All callable RG-Algorithms exists in two versions, the resulting shares are the same.
+/*  SIMD Dispatch:
+    If this Option is non-zero, the hot loops (share derivation, stacking, BMP conversion and
+    the ChaCha20 keystream) are compiled for SSE2, AVX2 and AVX-512, and the best version for
+    the running CPU is chosen at startup. Requires GCC or Clang on x86-64, otherwise the
+    loops are compiled once.
 
-    0 = normal versions
-    1 = alternate versions
+    Note: Used in simdKernels.h
+*/
+#define SIMD_DISPATCH 1
+
+/*  Non-temporal Stores:
+    If this Option is non-zero, the pixel-expanded deterministic shares are written with
+    non-temporal stores (x86-64 only), which bypass the cache. The shares are written once
+    and not read again before they are saved, so they don't displace the working data.
+
+    Note: Used in simdKernels.c
+*/
+#define NON_TEMPORAL_STORES 0
+
+/*  Stream Row Bands:
+    STREAM_ROW_BANDS = if non-zero, the algorithms read the source image in bands of rows.
+    Each band is encrypted and appended to the share files right away, instead of holding the
+    whole source and all shares in memory. So the memory needed doesn't grow with the height
+    of the image. The time measurement and the decryption always keep the whole images in
+    memory.
+    STREAM_BAND_HEIGHT = number of share rows per band, the pixel expanded shares of the
+    deterministic algorithm get fewer source rows per band (but at least one)
 
     Note: Used in vcAlgorithms.c
 */
-#define RG_VERSION 0
+#define STREAM_ROW_BANDS   1
+#define STREAM_BAND_HEIGHT 64
+
+/*  Maximum Number of Shares:
+    Upper limit for the number of shares "n" asked in the menu. The basis matrices of the
+    deterministic and probabilistic algorithm have 2^(n-1) columns, so the pixel expansion of
+    the deterministic shares grows the same way, e.g. 128x256 share pixels per source pixel
+    for n=16. Must not exceed 31.
+
+    Note: Used in menu.c and decrypt.c
+*/
+#define MAX_NUMBER_OF_SHARES 16
+
+/*  Print Basis Matrices:
+    If this Option is non-zero, the program will print the basis matrices, when the
+    deterministic algorithm is called.
+
+    Note: Used in basisStore.c
+*/
+#define PRINT_BASIS_MATRICES 0
 
 /* TIME MEASUREMENT OPTIONS */
 
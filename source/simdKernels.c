@@ -0,0 +1,248 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#include "simdKernels.h"
+
+#include <string.h>
+
+#if NON_TEMPORAL_STORES && defined(__x86_64__)
+#include <immintrin.h>
+#define USE_STREAMING_STORES 1
+#endif
+
+#define STACK_BLOCK_SIZE 4096  // bytes per block of stackBytes(), fits into the L1 cache
+
+/*  Luminance in fixed point of 1/10000: the weights 0.2126 (red), 0.7152 (green) and 0.0722
+    (blue) are integers in this scale and add up to exactly 10000, so there is no rounding error.
+    A pixel is white, if its luminance rounded half up to an integer is greater than THRESHOLD
+    (clamped to -1 ... 255).
+*/
+#define WEIGHT_RED   2126
+#define WEIGHT_GREEN 7152
+#define WEIGHT_BLUE  722
+
+#define CLAMPED_THRESHOLD (THRESHOLD < -1 ? -1 : THRESHOLD > 255 ? 255 : THRESHOLD)
+#define MIN_WHITE_LUMINANCE ((CLAMPED_THRESHOLD + 1) * 10000 - 5000)
+
+/*********************************************************************
+ * Function:     isBlackBgr
+ *--------------------------------------------------------------------
+ * Description:  Return 1 if the pixel with the color bytes blue,
+ *               green and red at "bgr" is black, 0 if it is white.
+ ********************************************************************/
+static inline Pixel isBlackBgr(const uint8_t *bgr) {
+    int32_t luminance = WEIGHT_BLUE * bgr[0] + WEIGHT_GREEN * bgr[1] + WEIGHT_RED * bgr[2];
+    return luminance < MIN_WHITE_LUMINANCE;
+}
+
+/*********************************************************************
+ * Function:     thresholdBgrBlock
+ *--------------------------------------------------------------------
+ * Description:  Threshold "count" pixel of "bytesPerPixel" bytes each.
+ *               Called with a constant "bytesPerPixel", so the loop is
+ *               vectorized for the stride of 3 or 4 bytes.
+ ********************************************************************/
+static inline void thresholdBgrBlock(const uint8_t *source, Pixel *dest, int count, int bytesPerPixel) {
+    for (int i = 0; i < count; i++) {
+        dest[i] = isBlackBgr(source + bytesPerPixel * i);  // white = 0, black = 1
+    }
+}
+
+/*********************************************************************
+ * Function:     readBinaryBgrBlock
+ *--------------------------------------------------------------------
+ * Description:  Read "count" pure black or white pixel of 3 bytes
+ *               each by their blue byte, see readBinaryBgrToPixels().
+ * Return:       0 if all pixel are pure black or white, any other
+ *               value if "dest" is invalid.
+ ********************************************************************/
+static inline uint8_t readBinaryBgrBlock(const uint8_t *source, Pixel *dest, int count, Pixel black, Pixel white) {
+    uint8_t invalid = 0;
+    for (int i = 0; i < count; i++) {
+        uint8_t blue = source[3 * i];
+
+        // any color byte besides 0 and 255, or a byte that differs from blue, makes the row invalid
+        invalid |= (blue ^ source[3 * i + 1]) | (blue ^ source[3 * i + 2]) | (uint8_t)(blue + 1) >> 1;
+        dest[i] = (blue & white) | (~blue & black);
+    }
+    return invalid;
+}
+
+/*********************************************************************
+ * Function:     packPixelBlock
+ *--------------------------------------------------------------------
+ * Description:  Return the 64 pixel (0/1) of "block" packed into a
+ *               word. A multiplication gathers bit 0 of 8 bytes
+ *               (little-endian) in its top byte.
+ ********************************************************************/
+static inline uint64_t packPixelBlock(const Pixel *block) {
+    uint64_t bits = 0;
+    for (int byte = 0; byte < 8; byte++) {
+        uint64_t eightPixel;
+        memcpy(&eightPixel, block + 8 * byte, sizeof(eightPixel));
+        bits |= ((eightPixel * 0x0102040810204080ULL) >> 56) << (8 * byte);
+    }
+    return bits;
+}
+
+SimdLevel getSimdLevel() {
+#ifdef SIMD_CLONES
+    static int initialized = 0;
+    static SimdLevel level = SIMD_LEVEL_SSE2;
+
+    if (!initialized) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            level = SIMD_LEVEL_AVX512;
+        } else if (__builtin_cpu_supports("avx2")) {
+            level = SIMD_LEVEL_AVX2;
+        }
+        initialized = 1;
+    }
+    return level;
+#else
+    return SIMD_LEVEL_SCALAR;
+#endif
+}
+
+const char *getSimdLevelName() {
+    switch (getSimdLevel()) {
+        case SIMD_LEVEL_AVX512:
+            return "AVX-512";
+        case SIMD_LEVEL_AVX2:
+            return "AVX2";
+        case SIMD_LEVEL_SSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+    }
+}
+
+SIMD_KERNEL void xorWords(uint64_t *dest, const uint64_t *source, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dest[i] ^= source[i];
+    }
+}
+
+SIMD_KERNEL void selectWords(uint64_t *dest, const uint64_t *grid, const uint64_t *mask, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dest[i] = (dest[i] & mask[i]) | (grid[i] & ~mask[i]);
+    }
+}
+
+SIMD_KERNEL void stackBytes(uint8_t *dest, const uint8_t *const *sources, int numSources, size_t size) {
+    // for each block
+    for (size_t start = 0; start < size; start += STACK_BLOCK_SIZE) {
+        size_t blockSize = size - start < STACK_BLOCK_SIZE ? size - start : STACK_BLOCK_SIZE;
+        uint8_t *destBlock = dest + start;
+        memcpy(destBlock, sources[0] + start, blockSize);
+
+        // the block of "dest" stays in cache, while the other shares are OR-ed into it
+        for (int idx = 1; idx < numSources; idx++) {
+            const uint8_t *sourceBlock = sources[idx] + start;
+            for (size_t i = 0; i < blockSize; i++) {
+                destBlock[i] |= sourceBlock[i];
+            }
+        }
+    }
+}
+
+SIMD_KERNEL void expandPixelsToBgr(const Pixel *source, uint8_t *dest, int width) {
+    for (int column = 0; column < width; column++) {
+        uint8_t color = source[column] ? 0 : 255;  // black = 0, white = 255
+        dest[3 * column] = color;                  // blue
+        dest[3 * column + 1] = color;              // green
+        dest[3 * column + 2] = color;              // red
+    }
+}
+
+SIMD_KERNEL void thresholdBgrToPixels(const uint8_t *source, Pixel *dest, int width, int bytesPerPixel) {
+    if (bytesPerPixel == 4) {
+        thresholdBgrBlock(source, dest, width, 4);
+    } else {
+        thresholdBgrBlock(source, dest, width, 3);
+    }
+}
+
+SIMD_KERNEL void thresholdBgrToWords(const uint8_t *source, uint64_t *dest, int width, int bytesPerPixel) {
+    Pixel block[64];
+
+    // for each word
+    for (int word = 0; word * 64 < width; word++) {
+        int count = width - word * 64 < 64 ? width - word * 64 : 64;
+        const uint8_t *bgr = source + (size_t)bytesPerPixel * 64 * word;
+        if (bytesPerPixel == 4) {
+            thresholdBgrBlock(bgr, block, count, 4);
+        } else {
+            thresholdBgrBlock(bgr, block, count, 3);
+        }
+        memset(block + count, 0, 64 - count);  // unused bits of the row are zero
+        dest[word] = packPixelBlock(block);
+    }
+}
+
+SIMD_KERNEL void thresholdGrayToWords(const uint8_t *source, uint64_t *dest, int width, int minWhite) {
+    Pixel block[64];
+
+    // for each word
+    for (int word = 0; word * 64 < width; word++) {
+        int count = width - word * 64 < 64 ? width - word * 64 : 64;
+        const uint8_t *gray = source + 64 * word;
+        for (int i = 0; i < count; i++) {
+            block[i] = gray[i] < minWhite;
+        }
+        memset(block + count, 0, 64 - count);  // unused bits of the row are zero
+        dest[word] = packPixelBlock(block);
+    }
+}
+
+SIMD_KERNEL void lookupPixelsToWords(const uint8_t *source, uint64_t *dest, int width, const Pixel *palette) {
+    Pixel block[64];
+
+    // for each word
+    for (int word = 0; word * 64 < width; word++) {
+        int count = width - word * 64 < 64 ? width - word * 64 : 64;
+        const uint8_t *index = source + 64 * word;
+        for (int i = 0; i < count; i++) {
+            block[i] = palette[index[i]];
+        }
+        memset(block + count, 0, 64 - count);  // unused bits of the row are zero
+        dest[word] = packPixelBlock(block);
+    }
+}
+
+SIMD_KERNEL int readBinaryBgrToPixels(const uint8_t *source, Pixel *dest, int width, Pixel black, Pixel white) {
+    return !readBinaryBgrBlock(source, dest, width, black, white);
+}
+
+SIMD_KERNEL int readBinaryBgrToWords(const uint8_t *source, uint64_t *dest, int width, Pixel black, Pixel white) {
+    Pixel block[64];
+    uint8_t invalid = 0;
+
+    // for each word
+    for (int word = 0; word * 64 < width; word++) {
+        int count = width - word * 64 < 64 ? width - word * 64 : 64;
+        invalid |= readBinaryBgrBlock(source + 3 * 64 * (size_t)word, block, count, black, white);
+        memset(block + count, 0, 64 - count);  // unused bits of the row are zero
+        dest[word] = packPixelBlock(block);
+    }
+    return !invalid;
+}
+
+void streamWords(uint64_t *dest, const uint64_t *source, size_t count) {
+#ifdef USE_STREAMING_STORES
+    for (size_t i = 0; i < count; i++) {
+        _mm_stream_si64((long long *)&dest[i], (long long)source[i]);
+    }
+#else
+    memcpy(dest, source, count * sizeof(uint64_t));
+#endif
+}
+
+void streamFence() {
+#ifdef USE_STREAMING_STORES
+    _mm_sfence();
+#endif
+}
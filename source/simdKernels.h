@@ -0,0 +1,184 @@
+/*
+*   Copyright: (c) 2023 Sabrina Otto. All rights reserved.
+*   This work is licensed under the terms of the MIT license.
+*/
+
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "settings.h"
+
+#ifndef TYPE_PIXEL
+#define TYPE_PIXEL
+
+typedef uint8_t Pixel;  // black / white
+
+#endif  // TYPE_PIXEL
+
+/*  The kernels are compiled once per instruction set and the best version for the running
+    CPU is chosen at startup (GCC function multi-versioning), so one binary fits all hosts.
+    Without x86-64 or compiler support, the kernels are compiled once (SIMD_LEVEL_SCALAR).
+*/
+#if SIMD_DISPATCH && defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define SIMD_CLONES 1
+#endif
+#endif
+
+#ifdef SIMD_CLONES
+#define SIMD_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_KERNEL
+#endif
+
+typedef enum {
+    SIMD_LEVEL_SCALAR,  // no dispatch, compiler defaults only
+    SIMD_LEVEL_SSE2,    // "default" clone on x86-64
+    SIMD_LEVEL_AVX2,
+    SIMD_LEVEL_AVX512
+} SimdLevel;
+
+/*********************************************************************
+ * Function:     getSimdLevel
+ *--------------------------------------------------------------------
+ * Description:  Return the instruction set, that is used by the
+ *               SIMD_KERNEL functions on this CPU. The priority is
+ *               the same as the one of the multi-versioning.
+ ********************************************************************/
+SimdLevel getSimdLevel();
+
+/*********************************************************************
+ * Function:     getSimdLevelName
+ *--------------------------------------------------------------------
+ * Description:  Return the name of the instruction set returned by
+ *               getSimdLevel(), for verbose output and the log.
+ ********************************************************************/
+const char *getSimdLevelName();
+
+/*********************************************************************
+ * Function:     xorWords
+ *--------------------------------------------------------------------
+ * Description:  dest[i] ^= source[i] for "count" words.
+ *               Used to derive the last (n,n) random grid share.
+ ********************************************************************/
+void xorWords(uint64_t *dest, const uint64_t *source, size_t count);
+
+/*********************************************************************
+ * Function:     selectWords
+ *--------------------------------------------------------------------
+ * Description:  dest[i] = (dest[i] AND mask[i]) OR (grid[i] AND NOT
+ *               mask[i]) for "count" words. Used to derive the (2,n)
+ *               random grid shares, where "dest" holds random words
+ *               and "mask" the source.
+ ********************************************************************/
+void selectWords(uint64_t *dest, const uint64_t *grid, const uint64_t *mask, size_t count);
+
+/*********************************************************************
+ * Function:     stackBytes
+ *--------------------------------------------------------------------
+ * Description:  dest[i] = sources[0][i] OR ... OR sources[k-1][i] for
+ *               "size" bytes, which stacks k shares in either pixel
+ *               layout. The buffers are processed in blocks that fit
+ *               into the L1 cache, so every source is read once and
+ *               "dest" is written once, instead of one pass over
+ *               memory per share.
+ ********************************************************************/
+void stackBytes(uint8_t *dest, const uint8_t *const *sources, int numSources, size_t size);
+
+/*********************************************************************
+ * Function:     expandPixelsToBgr
+ *--------------------------------------------------------------------
+ * Description:  Write three equal color bytes per pixel of "source"
+ *               to "dest": 0 for black pixel (1) and 255 for white
+ *               ones (0).
+ ********************************************************************/
+void expandPixelsToBgr(const Pixel *source, uint8_t *dest, int width);
+
+/*********************************************************************
+ * Function:     thresholdBgrToPixels
+ *--------------------------------------------------------------------
+ * Description:  Weight the three color bytes (blue, green, red) per
+ *               pixel of "source" and decide with THRESHOLD, whether
+ *               the pixel is white (0) or black (1). The luminance is
+ *               calculated exactly in fixed point of 1/10000 with
+ *               integer multiplies and rounded half up, so the result
+ *               is the same on every CPU.
+ *               A pixel has "bytesPerPixel" (3 or 4) bytes, the fourth
+ *               one (alpha or unused) is ignored.
+ ********************************************************************/
+void thresholdBgrToPixels(const uint8_t *source, Pixel *dest, int width, int bytesPerPixel);
+
+/*********************************************************************
+ * Function:     thresholdBgrToWords
+ *--------------------------------------------------------------------
+ * Description:  Same as thresholdBgrToPixels(), but the pixel are
+ *               stored bit-packed in the words of "dest", 64 pixel per
+ *               word. The unused bits of the last word are zero.
+ ********************************************************************/
+void thresholdBgrToWords(const uint8_t *source, uint64_t *dest, int width, int bytesPerPixel);
+
+/*********************************************************************
+ * Function:     thresholdGrayToWords
+ *--------------------------------------------------------------------
+ * Description:  Store the bytes of "source" bit-packed in the words of
+ *               "dest": bytes below "minWhite" are black (1), the
+ *               others white (0). Used for palette indices of 8 bit
+ *               images, whose palette is sorted from dark to bright,
+ *               like the one of gray scale images.
+ ********************************************************************/
+void thresholdGrayToWords(const uint8_t *source, uint64_t *dest, int width, int minWhite);
+
+/*********************************************************************
+ * Function:     lookupPixelsToWords
+ *--------------------------------------------------------------------
+ * Description:  Store the pixel palette[source[i]] of the bytes of
+ *               "source" bit-packed in the words of "dest". Used for
+ *               palette indices of 8 bit images with any palette.
+ ********************************************************************/
+void lookupPixelsToWords(const uint8_t *source, uint64_t *dest, int width, const Pixel *palette);
+
+/*********************************************************************
+ * Function:     readBinaryBgrToPixels
+ *--------------------------------------------------------------------
+ * Description:  Fast path of thresholdBgrToPixels() for black and
+ *               white images, like the shares: only the blue byte of
+ *               each pixel is tested, 0 gives "black" and 255 gives
+ *               "white" (the results of thresholdBgrToPixels() for
+ *               those colors). The other bytes are only compared in
+ *               the same pass, to validate the row.
+ * Return:       1 if all pixel of "source" are pure black or white,
+ *               0 if "dest" is invalid and the row must be
+ *               thresholded.
+ ********************************************************************/
+int readBinaryBgrToPixels(const uint8_t *source, Pixel *dest, int width, Pixel black, Pixel white);
+
+/*********************************************************************
+ * Function:     readBinaryBgrToWords
+ *--------------------------------------------------------------------
+ * Description:  Same as readBinaryBgrToPixels(), but the pixel are
+ *               stored bit-packed in the words of "dest", like the
+ *               ones of thresholdBgrToWords().
+ ********************************************************************/
+int readBinaryBgrToWords(const uint8_t *source, uint64_t *dest, int width, Pixel black, Pixel white);
+
+/*********************************************************************
+ * Function:     streamWords
+ *--------------------------------------------------------------------
+ * Description:  Copy "count" words from "source" to "dest". If
+ *               NON_TEMPORAL_STORES is set, "dest" is written past
+ *               the cache, so streamFence() has to be called before
+ *               "dest" is read.
+ ********************************************************************/
+void streamWords(uint64_t *dest, const uint64_t *source, size_t count);
+
+/*********************************************************************
+ * Function:     streamFence
+ *--------------------------------------------------------------------
+ * Description:  Wait until all words of streamWords() are written.
+ ********************************************************************/
+void streamFence();
+
+#endif /* SIMD_KERNELS_H */
@@ -12,11 +12,10 @@
 #include "memoryManagement.h"
 #include "menu.h"
 #include "settings.h"
+#include "simdKernels.h"
 #include "vcAlg01_deterministic.h"
 #include "vcAlg02_probabilistic.h"
 #include "vcAlg03_randomGrid.h"
-#include "vcAlg03_randomGrid_V0.h"
-#include "vcAlg03_randomGrid_V1.h"
 #include "vcAlgorithms.h"
 
 /*********************************************************************
@@ -54,7 +53,7 @@ void timeMeasurement(char *logPath) {
     int n = getNfromUser();
     int k = getKfromUser(n);
 
-    FILE *randomSrc = xfopen(RANDOM_FILE_PATH, "r");
+    RandomPool *randomSrc = createRandomPool();
 
     Image source;
     createSourceImage(&source);
@@ -68,13 +67,7 @@ void timeMeasurement(char *logPath) {
     probabilisticData *pData = prepareProbabilisticAlgorithm(&_pData);
 
     // prepare random grid algorithms
-    int arraySize = source.width * source.height;
-    Pixel *storage = xmalloc(arraySize);
-    Pixel *sharePixel = xmalloc(k * sizeof(Pixel));
-    Pixel *tmpSharePixel = xmalloc(n * sizeof(Pixel));
-    Image *tmpShares = xmalloc(k * sizeof(Image));
-    mallocSharesOfSourceSize(&source, tmpShares, k);
-    int *setOfN = createSetOfN(n, 1);
+    SubsetTable subsets = createSubsetTable(n, k);
 
     /*_________________________ START TIME MEASUREMENT _________________________*/
 
@@ -88,8 +81,12 @@ void timeMeasurement(char *logPath) {
             "algorithm loops: %d\n"
             "number of shares (n): %d\n"
             "number of shares to stack (k): %d\n"
-            "Image size in px: %d x %d\n\n",
-            TIME_LOOPS, n, k, source.width, source.height);
+            "Image size in px: %d x %d\n"
+            "random source: %s\n"
+            "random pool size in bytes: %d%s\n"
+            "SIMD kernels: %s\n\n",
+            TIME_LOOPS, n, k, source.width, source.height, randomSrc->source.name, RANDOM_POOL_SIZE,
+            RANDOM_POOL_DOUBLE_BUFFERED ? " (double buffered)" : "", getSimdLevelName());
 
     // deterministic algorithm
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
@@ -110,57 +107,32 @@ void timeMeasurement(char *logPath) {
     // (n,n) random grid algorithm
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
     for (int i = 0; i < TIME_LOOPS; i++) {
-        randomGrid_nn(source.array, shares, &storage, randomSrc, arraySize, n);
+        randomGrid_nn(&source, shares, randomSrc, n);
     }
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
     printMeasuredTime(logFile, &start, &stop, "(n,n) random grid");
 
-    // alternate (n,n) random grid algorithm
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
-    for (int i = 0; i < TIME_LOOPS; i++) {
-        alternate_nn_RGA(source.array, shares, tmpSharePixel, randomSrc, arraySize, n);
-    }
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
-    printMeasuredTime(logFile, &start, &stop, "alternate (n,n) random grid");
-
     // (2,n) random grid algorithm
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
     for (int i = 0; i < TIME_LOOPS; i++) {
-        randomGrid_2n(source.array, shares, randomSrc, arraySize, n);
+        randomGrid_2n(&source, shares, randomSrc, n);
     }
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
     printMeasuredTime(logFile, &start, &stop, "(2,n) random grid");
 
-    // alternate (2,n) random grid algorithm
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
-    for (int i = 0; i < TIME_LOOPS; i++) {
-        alternate_2n_RGA(source.array, shares, randomSrc, arraySize, n);
-    }
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
-    printMeasuredTime(logFile, &start, &stop, "alternate (2,n) random grid");
-
     // (k,n) random grid algorithm
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
     for (int i = 0; i < TIME_LOOPS; i++) {
-        // since the (k,n) needs additional shares filled by the (n,n), the time must be added
-        randomGrid_nn(source.array, tmpShares, &storage, randomSrc, arraySize, k);
-        __randomGrid_kn(setOfN, shares, tmpShares, randomSrc, arraySize, n, k);
+        __randomGrid_kn(&subsets, &source, shares, randomSrc);
     }
     clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
     printMeasuredTime(logFile, &start, &stop, "(k,n) random grid");
 
-    // alternate (k,n) random grid algorithm
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
-    for (int i = 0; i < TIME_LOOPS; i++) {
-        __alternate_kn_RGA(setOfN, source.array, sharePixel, shares, randomSrc, arraySize, n, k);
-    }
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
-    printMeasuredTime(logFile, &start, &stop, "alternate (k,n) random grid");
-
     fprintf(logFile, "__________________________________________________\n\n");
 
     fprintf(stdout, "Success!\nResult was stored in %s\n", logPath);
 
+    closeRandomPool(randomSrc);
     xcloseAll();
     xfreeAll();
 }
@@ -8,10 +8,16 @@
 #include <math.h>
 #include <string.h>
 
+#include "basisStore.h"
 #include "fileManagement.h"
+#include "handleBMP.h"
 #include "image.h"
 #include "memoryManagement.h"
 #include "random.h"
+#include "settings.h"
+#include "simdKernels.h"
+
+#define TILE_WORDS 8  // words per share row of a tile = one cache line
 
 void calcPixelExpansion(int *deterministicHeight, int *deterministicWidth, int n, int m) {
     if (n % 2)  // odd
@@ -30,7 +36,7 @@ void calcPixelExpansion(int *deterministicHeight, int *deterministicWidth, int n
     }
 }
 
-void mallocPixelExpandedShares(Image *source, Image *share, int n, int m) {
+void mallocPixelExpandedShares(Image *source, Image *share, int n, int m, PixelLayout layout) {
     int deterministicHeight, deterministicWidth;
     calcPixelExpansion(&deterministicHeight, &deterministicWidth, n, m);
 
@@ -38,6 +44,7 @@ void mallocPixelExpandedShares(Image *source, Image *share, int n, int m) {
     for (int i = 0; i < n; i++) {
         share[i].height = source->height * deterministicHeight;
         share[i].width = source->width * deterministicWidth;
+        share[i].layout = layout;
         mallocPixelArray(&share[i]);
     }
 }
@@ -46,20 +53,21 @@ void mallocPixelExpandedShares(Image *source, Image *share, int n, int m) {
  * Function:     permutateBasisMatrix
  *--------------------------------------------------------------------
  * Description:  Permutate the columns of a basis matrix and store
- *               the permutation in the array "permutation".
- * Input:        B0 = Basis matrix for white share-pixels
- *               B1 = Basis matrix for black share-pixels
+ *               the permutation in the matrix "permutation".
+ * Input:        B0 = column masks of the basis matrix for white
+ *               share-pixels
+ *               B1 = column masks of the basis matrix for black
+ *               share-pixels
+ *               order = column order, which is shuffled in place
  *               sourcePixel = pixel of the secret image (0/1)
- *               columnCheckList = containing zero's for unused
- *               basis matrix columns and one's for allready used
- *               ones
- *               randomSrc = file containing random numbers
- * Output:       permutation = either the column-permutation of
+ *               randomSrc = pool containing random numbers
+ * Output:       columns = column masks of the permutation
+ *               permutation = either the column-permutation of
  *               B0 or B1
  ********************************************************************/
-static void permutateBasisMatrix(BooleanMatrix *B0, BooleanMatrix *B1, BooleanMatrix *permutation, Pixel sourcePixel,
-                                 int *columnIndices, FILE *randomSrc) {
-    BooleanMatrix *basisMatrix;
+static inline void permutateBasisMatrix(const int *B0, const int *B1, int *order, int *columns,
+                                        BooleanMatrix *permutation, Pixel sourcePixel, RandomPool *randomSrc) {
+    const int *basisMatrix;
     if (sourcePixel)  // source pixel is black
     {
         basisMatrix = B1;
@@ -68,69 +76,107 @@ static void permutateBasisMatrix(BooleanMatrix *B0, BooleanMatrix *B1, BooleanMa
         basisMatrix = B0;
     }
 
-    shuffleColumns(permutation, basisMatrix, randomSrc, columnIndices);
+    /*  the order is shuffled in place, since a random permutation of an already permutated
+        order is still a random one. The basis matrices stay untouched in the mapped store.
+    */
+    shuffleVector(order, permutation->width, randomSrc);
+    for (int i = 0; i < permutation->width; i++) {
+        columns[i] = basisMatrix[order[i]];
+    }
+    transposeColumnMasks(permutation, columns);
 }
 
 /*********************************************************************
- * Function:     copyMatrixRowToShares
+ * Function:     copyMatrixRowToTile
  *--------------------------------------------------------------------
- * Description:  The function copyMatrixRowToShares copies the
- *               pixel array of matrixRow2D to the pixel array of a
- *               share, starting at row posY and column posX of the
- *               share.
+ * Description:  The function copyMatrixRowToTile interprets the row
+ *               "matrixRow" of "permutation" as 2D-array of the size
+ *               deterministicHeight x deterministicWidth and copies
+ *               it to the tile of a share, starting at column posX of
+ *               the tile. The 2D-arrays are a power of two wide, so
+ *               they never cross a word boundary of the tile.
  ********************************************************************/
-static void copyMatrixRowToShares(BooleanMatrix matrixRow2D, Image *share, int posY, int posX) {
-    int width = share->width;
+static inline void copyMatrixRowToTile(BooleanMatrix *permutation, int matrixRow, uint64_t *tile, int tileWords,
+                                       int posX, int deterministicHeight, int deterministicWidth) {
+    int bitsPerWord = deterministicWidth < 64 ? deterministicWidth : 64;
 
-    // for each pixel of matrixRow2D
-    for (int i = 0; i < matrixRow2D.height; i++)  // rows
-    {
-        for (int j = 0; j < matrixRow2D.width; j++)  // columns
-        {
-            share->array[(posY + i) * width + posX + j] = getPixel(matrixRow2D, i, j);
+    // for each row of the 2D-array
+    for (int i = 0; i < deterministicHeight; i++) {
+        uint64_t *tileRow = tile + i * tileWords + posX / 64;
+        for (int word = 0; word * 64 < deterministicWidth; word++) {
+            uint64_t bits = getPixelBits(*permutation, matrixRow, i * deterministicWidth + word * 64, bitsPerWord);
+            tileRow[word] |= bits << (posX & 63);
         }
     }
 }
 
 /*********************************************************************
- * Function:     fillPixelEncryptionToShares
+ * Function:     fillPixelEncryptionToTile
  *--------------------------------------------------------------------
- * Description:  point with "matrixRow2D" temporarily to each
- *               permutation-array-row, where the row will be
- *               interpreted as 2D-array. Then fill the 2D-array
- *               "matrixRow2D" randomly in one of the shares,
- *               so each share will finally get a different
- *               (2D-sorted) row of the permutation-array.
+ * Description:  Interpret each permutation-array-row as 2D-array,
+ *               and fill it in the tile of one of the shares, so each
+ *               share will finally get a different (2D-sorted) row
+ *               of the permutation-array.
+ *               The tile holds deterministicHeight rows of
+ *               "tileWords" words per share.
  ********************************************************************/
-static void fillPixelEncryptionToShares(BooleanMatrix *permutation, BooleanMatrix matrixRow2D, Image *share, int posY,
-                                        int posX, int *rowIndices, FILE *randomSrc) {
+static inline void fillPixelEncryptionToTile(BooleanMatrix *permutation, uint64_t *tile, int tileWords, int posX,
+                                             int deterministicHeight, int deterministicWidth) {
     int n = permutation->height;
-    int m = permutation->width;
-    int randNum;
-
-    shuffleVector(rowIndices, n, randomSrc);
 
-    Pixel *shuffledBasisMatrix = permutation->array;
+    // for each share
+    for (int shareIdx = 0; shareIdx < n; shareIdx++) {
+        copyMatrixRowToTile(permutation, shareIdx, tile + shareIdx * deterministicHeight * tileWords, tileWords, posX,
+                            deterministicHeight, deterministicWidth);
+    }
+}
 
+/*********************************************************************
+ * Function:     copyTileToShares
+ *--------------------------------------------------------------------
+ * Description:  Copy the first "numWords" words of each tile row to
+ *               the shares, starting at row posY and word "posWord"
+ *               of the share. Each share row of the tile is written
+ *               at once, so the shares are filled one contiguous
+ *               cache line after another.
+ ********************************************************************/
+static inline void copyTileToShares(uint64_t *tile, int tileWords, Image *share, int n, int posY, int posWord,
+                                    int numWords, int deterministicHeight) {
     // for each share
     for (int shareIdx = 0; shareIdx < n; shareIdx++) {
-        randNum = rowIndices[shareIdx];
-        matrixRow2D.array = &(shuffledBasisMatrix[randNum * m]);  // first element of a random matrix row
-        copyMatrixRowToShares(matrixRow2D, &share[shareIdx], posY, posX);
+        // for each row of the tile
+        for (int i = 0; i < deterministicHeight; i++) {
+            uint64_t *shareRow = share[shareIdx].words + (size_t)(posY + i) * share[shareIdx].stride;
+            streamWords(shareRow + posWord, tile + (shareIdx * deterministicHeight + i) * tileWords, numWords);
+        }
     }
 }
 
-deterministicData *prepareDeterministicAlgorithm(AlgorithmData *data) {
+/*********************************************************************
+ * Function:     calcTilePixels
+ *--------------------------------------------------------------------
+ * Description:  Return the number of source pixel per tile, so a tile
+ *               row is TILE_WORDS words wide (or one pixel, if the
+ *               pixel is wider).
+ ********************************************************************/
+static inline int calcTilePixels(int deterministicWidth) {
+    return deterministicWidth < TILE_WORDS * 64 ? TILE_WORDS * 64 / deterministicWidth : 1;
+}
+
+/*********************************************************************
+ * Function:     createDeterministicData
+ *--------------------------------------------------------------------
+ * Description:  Allocate and prepare all data of the deterministic
+ *               algorithm, except for the pixel arrays of the shares.
+ ********************************************************************/
+static deterministicData *createDeterministicData(AlgorithmData *data) {
     int n = data->numberOfShares;
     int m = 1 << (n - 1);  // number of pixels in a share per pixel in source file = 2^{n-1}
 
-    // allocate pixel-arrays for the shares
-    mallocPixelExpandedShares(data->source, data->shares, n, m);
-
-    // create basis matrices
-    BooleanMatrix B0 = createBooleanMatrix(n, m);
-    BooleanMatrix B1 = createBooleanMatrix(n, m);
-    fillBasisMatrices(&B0, &B1);
+    /*  the column masks of the basis matrices are used right from the store, only the order of
+        their columns is permutated
+    */
+    BasisMatrices basis = loadBasisMatrices(n, n);
 
     int deterministicHeight, deterministicWidth;
     calcPixelExpansion(&deterministicHeight, &deterministicWidth, n, m);
@@ -140,19 +186,21 @@ deterministicData *prepareDeterministicAlgorithm(AlgorithmData *data) {
     */
     BooleanMatrix permutation = createBooleanMatrix(n, m);
 
-    /*  create checklist of size n (/m) to shuffle the rows (/columns)
-        of the basis matrices
+    /*  create a tile, which collects the share rows of TILE_WORDS words
+        (or of a single source pixel, if that is wider)
     */
-    int *rowIndices = createSetOfN(n, 0);
-    int *columnIndices = createSetOfN(m, 0);
+    int tilePixels = calcTilePixels(deterministicWidth);
+    int tileWords = tilePixels * deterministicWidth / 64;
+    uint64_t *tile = xmalloc((size_t)n * deterministicHeight * tileWords * sizeof(uint64_t));
 
     deterministicData *dData = xmalloc(sizeof(deterministicData));
-    dData->B0 = B0;
-    dData->B1 = B1;
+    dData->B0 = basis.B0;
+    dData->B1 = basis.B1;
+    dData->order = xmalloc(m * sizeof(int));
+    dData->columns = xmalloc(m * sizeof(int));
     dData->permutation = permutation;
-    dData->sourceArray = data->source->array;
-    dData->columnIndices = columnIndices;
-    dData->rowIndices = rowIndices;
+    dData->tile = tile;
+    dData->source = data->source;
     dData->share = data->shares;
     dData->randomSrc = data->randomSrc;
     dData->width = data->source->width;
@@ -163,35 +211,149 @@ deterministicData *prepareDeterministicAlgorithm(AlgorithmData *data) {
     return dData;
 }
 
-void __deterministicAlgorithm(deterministicData *data) {
-    BooleanMatrix *B0 = &data->B0;
-    BooleanMatrix *B1 = &data->B1;
-    BooleanMatrix *permutation = &data->permutation;
-    Pixel *sourceArray = data->sourceArray;
-    int *columnIndices = data->columnIndices;
-    int *rowIndices = data->rowIndices;
-    Image *share = data->share;
-    FILE *randomSrc = data->randomSrc;
+deterministicData *prepareDeterministicAlgorithm(AlgorithmData *data) {
+    int n = data->numberOfShares;
+    int m = 1 << (n - 1);
+
+    // allocate bit-packed pixel-arrays for the shares, which are the largest buffer of the program
+    mallocPixelExpandedShares(data->source, data->shares, n, m, PIXEL_LAYOUT_PACKED);
+
+    return createDeterministicData(data);
+}
+
+/*********************************************************************
+ * Function:     encryptSourceRowWith
+ *--------------------------------------------------------------------
+ * Description:  Encrypt the pixel of row "row" of the secret image
+ *               to the rows posY to posY+deterministicHeight-1 of the
+ *               images "band", which have the width of the shares.
+ *               It is always inlined, so the instances with constant
+ *               "n" and pixel expansion get all loops over the
+ *               shares, the rows and the words of a pixel unrolled.
+ ********************************************************************/
+static inline __attribute__((always_inline)) void encryptSourceRowWith(deterministicData *data, int row, Image *band,
+                                                                       int posY, int n, int deterministicHeight,
+                                                                       int deterministicWidth) {
+    const int *B0 = data->B0;
+    const int *B1 = data->B1;
+    int *order = data->order;
+    int *columns = data->columns;
+    uint64_t *tile = data->tile;
+    Image *source = data->source;
+    RandomPool *randomSrc = data->randomSrc;
     int width = data->width;
-    int height = data->height;
-    int deterministicWidth = data->deterministicWidth;
-    int deterministicHeight = data->deterministicHeight;
-    BooleanMatrix matrixRow2D;
-    matrixRow2D.width = deterministicWidth;
-    matrixRow2D.height = deterministicHeight;
-
-    // for each pixel of the secret image
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            Pixel sourcePixel = sourceArray[i * width + j];
-            permutateBasisMatrix(B0, B1, permutation, sourcePixel, columnIndices, randomSrc);
-            fillPixelEncryptionToShares(permutation, matrixRow2D, share, i * deterministicHeight,
-                                        j * deterministicWidth, rowIndices, randomSrc);
+
+    // copy of the permutation matrix with a size, that is known at compile time
+    int m = 1 << (n - 1);
+    BooleanMatrix permutation = {.height = n, .width = m, .stride = (m + 63) / 64, .words = data->permutation.words};
+
+    int tilePixels = calcTilePixels(deterministicWidth);
+    int tileWords = tilePixels * deterministicWidth / 64;
+    size_t tileSize = (size_t)n * deterministicHeight * tileWords * sizeof(uint64_t);
+
+    /*  every row starts with the same order, so the shares of a row only depend on the random
+        numbers of the row (see seekRandomPool()) and not on the rows encrypted before
+    */
+    for (int i = 0; i < m; i++) {
+        order[i] = i;
+    }
+
+    // for each tile of the row
+    for (int tileStart = 0; tileStart < width; tileStart += tilePixels) {
+        int tileEnd = width < tileStart + tilePixels ? width : tileStart + tilePixels;
+        memset(tile, 0, tileSize);
+
+        // for each pixel of the tile
+        for (int j = tileStart; j < tileEnd; j++) {
+            Pixel sourcePixel = getImagePixel(source, row, j);
+            permutateBasisMatrix(B0, B1, order, columns, &permutation, sourcePixel, randomSrc);
+            fillPixelEncryptionToTile(&permutation, tile, tileWords, (j - tileStart) * deterministicWidth,
+                                      deterministicHeight, deterministicWidth);
         }
+
+        int numWords = ((tileEnd - tileStart) * deterministicWidth + 63) / 64;
+        copyTileToShares(tile, tileWords, band, n, posY, tileStart * deterministicWidth / 64, numWords,
+                         deterministicHeight);
     }
 }
 
+typedef void (*EncryptSourceRow)(deterministicData *data, int row, Image *band, int posY);
+
+/*  one instance of encryptSourceRowWith() per n up to SPECIALIZED_MAX_N, whose pixel expansion is
+    the one of calcPixelExpansion(): 2^((n-1)/2) rows of 2^(n/2) pixel
+*/
+#define ENCRYPT_SOURCE_ROW(N)                                                                 \
+    static void encryptSourceRow##N(deterministicData *data, int row, Image *band, int posY) { \
+        encryptSourceRowWith(data, row, band, posY, N, 1 << ((N - 1) / 2), 1 << (N / 2));     \
+    }
+
+ENCRYPT_SOURCE_ROW(2)
+ENCRYPT_SOURCE_ROW(3)
+ENCRYPT_SOURCE_ROW(4)
+ENCRYPT_SOURCE_ROW(5)
+ENCRYPT_SOURCE_ROW(6)
+ENCRYPT_SOURCE_ROW(7)
+ENCRYPT_SOURCE_ROW(8)
+
+static void encryptSourceRowGeneric(deterministicData *data, int row, Image *band, int posY) {
+    encryptSourceRowWith(data, row, band, posY, data->permutation.height, data->deterministicHeight,
+                         data->deterministicWidth);
+}
+
+static const EncryptSourceRow encryptSourceRowTable[SPECIALIZED_MAX_N + 1] = {
+    NULL,
+    NULL,
+    encryptSourceRow2,
+    encryptSourceRow3,
+    encryptSourceRow4,
+    encryptSourceRow5,
+    encryptSourceRow6,
+    encryptSourceRow7,
+    encryptSourceRow8,
+};
+
+/*********************************************************************
+ * Function:     getEncryptSourceRow
+ *--------------------------------------------------------------------
+ * Description:  Return the instance of encryptSourceRowWith() for
+ *               "n" shares.
+ ********************************************************************/
+static EncryptSourceRow getEncryptSourceRow(int n) {
+    return n <= SPECIALIZED_MAX_N ? encryptSourceRowTable[n] : encryptSourceRowGeneric;
+}
+
+/*********************************************************************
+ * Function:     encryptDeterministicBand
+ *--------------------------------------------------------------------
+ * Description:  Encrypt the rows of "source", which start at row
+ *               "firstRow" of the secret image, to the shares. Each
+ *               source row gets deterministicHeight rows of the
+ *               shares.
+ ********************************************************************/
+static void encryptDeterministicBand(void *context, Image *source, Image *shares, int firstRow) {
+    deterministicData *data = context;
+    EncryptSourceRow encryptSourceRow = getEncryptSourceRow(data->permutation.height);
+    data->source = source;
+
+    // for each row of the band
+    for (int i = 0; i < source->height; i++) {
+        seekRandomPool(data->randomSrc, 0, firstRow + i);
+        encryptSourceRow(data, i, shares, i * data->deterministicHeight);
+    }
+    streamFence();
+}
+
+void __deterministicAlgorithm(deterministicData *data) {
+    encryptDeterministicBand(data, data->source, data->share, 0);
+}
+
 void deterministicAlgorithm(AlgorithmData *data) {
+    if (data->sourceRows) {
+        deterministicData *dData = createDeterministicData(data);
+        streamAlgorithm(data, dData->deterministicHeight, dData->deterministicWidth, encryptDeterministicBand, dData);
+        return;
+    }
+
     deterministicData *dData = prepareDeterministicAlgorithm(data);
     __deterministicAlgorithm(dData);
 }
@@ -7,17 +7,19 @@
 #define DETERMINISTIC_ALGORITHMS_H
 
 #include "booleanMatrix.h"
+#include "random.h"
 #include "vcAlgorithms.h"
 
 typedef struct {
-    BooleanMatrix B0;
-    BooleanMatrix B1;
+    const int *B0;  // column masks of the basis matrix for white pixel, read-only (mapped store)
+    const int *B1;  // column masks of the basis matrix for black pixel, read-only (mapped store)
+    int *order;     // column order of the permutation, reset at the start of each row
+    int *columns;   // column masks of the permutated basis matrix
     BooleanMatrix permutation;
-    Pixel *sourceArray;
-    int *columnIndices;
-    int *rowIndices;
+    uint64_t *tile;  // share rows of a few encrypted pixels, before they are copied to the shares
+    Image *source;
     Image *share;
-    FILE *randomSrc;
+    RandomPool *randomSrc;
     int width;
     int height;
     int deterministicWidth;
@@ -52,10 +54,11 @@ void calcPixelExpansion(int *deterministicHeight, int *deterministicWidth, int n
  *               image,
  *               n = number of shares,
  *               m = number of pixels in a share per pixel in source,
- * Output:       share->array will be correctly allocated for each
- *               share
+ *               layout = PIXEL_LAYOUT_BYTE or PIXEL_LAYOUT_PACKED
+ * Output:       share->array (or share->words, if packed) will be
+ *               correctly allocated for each share
  ********************************************************************/
-void mallocPixelExpandedShares(Image *source, Image *share, int n, int m);
+void mallocPixelExpandedShares(Image *source, Image *share, int n, int m, PixelLayout layout);
 
 /*********************************************************************
  * Function:     prepareDeterministicAlgorithm
@@ -78,6 +81,15 @@ deterministicData *prepareDeterministicAlgorithm(AlgorithmData *data);
  *               The basis matrices will be afterwards permutated in
  *               columns and each share will get a different row of
  *               every permutation per source pixel.
+ *               The basis matrices are held as column masks, which
+ *               are shuffled and transposed to rows 8 columns at a
+ *               time. The rows aren't permutated: a row permutation
+ *               of B0 or B1 equals one of its column permutations, so
+ *               after the random column permutation the shares are
+ *               distributed the same way.
+ *               The shares are written in tiles: the pixels of a
+ *               source row are encrypted to a small buffer, from
+ *               which each share row gets a whole cache line.
  ********************************************************************/
 void __deterministicAlgorithm(deterministicData *data);
 
@@ -87,7 +99,8 @@ void __deterministicAlgorithm(deterministicData *data);
  * Description:  This is a wrapper for the "deterministic algorithm"
  *               from Moni Naor and Adi Shamir. It will prepare the
  *               resources needed by the algorithm and call it
- *               afterwards.
+ *               afterwards. If the source is read in bands, the
+ *               algorithm runs band by band with streamAlgorithm().
  ********************************************************************/
 void deterministicAlgorithm(AlgorithmData *data);
 
@@ -6,28 +6,21 @@
 #ifndef PROBABILISTIC_ALGORITHMS_H
 #define PROBABILISTIC_ALGORITHMS_H
 
-#include "booleanMatrix.h"
+#include "random.h"
 #include "vcAlgorithms.h"
 
 typedef struct {
-    BooleanMatrix B0;
-    BooleanMatrix B1;
-    BooleanMatrix columnVector;
-    Pixel *sourceArray;
-    int *rowIndices;
+    Image *source;
     Image *share;
-    FILE *randomSrc;
-    int width;
-    int height;
+    RandomPool *randomSrc;
+    int numberOfShares;
 } probabilisticData;
 
 /*********************************************************************
  * Function:     prepareProbabilisticAlgorithm
  *--------------------------------------------------------------------
  * Description:  This function will allocate all data of the
- *               probabilistic algorithm, which needs allocation, and
- *               prepares the basis matrices, which doesn't change for
- *               the same amount of share files.
+ *               probabilistic algorithm, which needs allocation.
  ********************************************************************/
 probabilisticData *prepareProbabilisticAlgorithm(AlgorithmData *data);
 
@@ -44,6 +37,10 @@ probabilisticData *prepareProbabilisticAlgorithm(AlgorithmData *data);
  *               one column of the basis matrix will be randomly chosen
  *               and each share will get a different element of the
  *               column as pixel value.
+ *               The randomly chosen and spread column is sampled
+ *               directly, without basis matrices: the shares get n-1
+ *               random bits and the last one completes the parity
+ *               (even for white, odd for black source pixel).
  ********************************************************************/
 void __probabilisticAlgorithm(probabilisticData *data);
 
@@ -53,7 +50,9 @@ void __probabilisticAlgorithm(probabilisticData *data);
  * Description:  This is a wrapper for the "probabilistic algorithm"
  *               from Ryo Ito, Hidenori Kuwakado and Hatsukazu Tanaka.
  *               It will prepare the resources needed by the algorithm
- *               and call it afterwards.
+ *               and call it afterwards. If the source is read in
+ *               bands, the algorithm runs band by band with
+ *               streamAlgorithm().
  ********************************************************************/
 void probabilisticAlgorithm(AlgorithmData *data);
 
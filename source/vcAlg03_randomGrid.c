@@ -7,30 +7,220 @@
 
 #include <string.h>
 
-#include "fileManagement.h"
 #include "image.h"
 #include "memoryManagement.h"
 #include "menu.h"
-#include "vcAlg03_randomGrid_V0.h"
-#include "vcAlg03_randomGrid_V1.h"
-
-void writePixelToShares(int *randSortedSetOfN, void *source, Image *shares, FILE *randomSrc, int n, int k, int i,
-                        Pixel (*getPixel)(void *, int, int)) {
-    // for each share
-    for (int idx = 0; idx < n; idx++) {
-        int found = -1;
-        for (int idk = 0; idk < k; idk++) {
-            if (randSortedSetOfN[idk] == idx + 1) {  // share idx is part of the first k elements
-                found = idk;
-                break;
-            }
+#include "simdKernels.h"
+
+void xorRandomGrids_nn(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares, int firstRow) {
+    int height = source->height;
+    int stride = source->stride;
+    uint64_t tailMask = getRowTailMask(source->width);
+    Image *lastShare = &shares[numberOfShares - 1];
+
+    // for each row of 64 pixel words
+    for (int row = 0; row < height; row++) {
+        seekRandomPool(randomSrc, 0, firstRow + row);
+        size_t offset = (size_t)row * stride;
+        uint64_t *lastRow = lastShare->words + offset;
+        memcpy(lastRow, source->words + offset, stride * sizeof(uint64_t));
+
+        // for each random grid
+        for (int idx = 0; idx < numberOfShares - 1; idx++) {
+            uint64_t *gridRow = shares[idx].words + offset;
+            getRandomWords(randomSrc, gridRow, stride);
+            gridRow[stride - 1] &= tailMask;
+            xorWords(lastRow, gridRow, stride);
+        }
+    }
+}
+
+void selectRandomGrids_2n(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares, int firstRow) {
+    int height = source->height;
+    int stride = source->stride;
+    uint64_t tailMask = getRowTailMask(source->width);
+
+    // for each row of 64 pixel words
+    for (int row = 0; row < height; row++) {
+        seekRandomPool(randomSrc, 0, firstRow + row);
+        size_t offset = (size_t)row * stride;
+        const uint64_t *sourceRow = source->words + offset;
+        uint64_t *gridRow = shares->words + offset;
+        getRandomWords(randomSrc, gridRow, stride);
+        gridRow[stride - 1] &= tailMask;
+
+        // for share 2 to n
+        for (int idx = 1; idx < numberOfShares; idx++) {
+            uint64_t *shareRow = shares[idx].words + offset;
+            getRandomWords(randomSrc, shareRow, stride);
+            selectWords(shareRow, gridRow, sourceRow, stride);
+        }
+    }
+}
+
+/*********************************************************************
+ * Function:     distributeRandomGridsWith
+ *--------------------------------------------------------------------
+ * Description:  Body of distributeRandomGrids_kn(). It is always
+ *               inlined, so the instances with constant "n" draw the
+ *               random bits of a pixel with a constant count and get
+ *               the transposition and the copy to the shares unrolled.
+ ********************************************************************/
+static inline __attribute__((always_inline)) void distributeRandomGridsWith(Image *source, Image *shares,
+                                                                            SubsetTable *subsets,
+                                                                            RandomPool *randomSrc, int firstRow,
+                                                                            int n) {
+    int width = source->width;
+    int height = source->height;
+    int stride = source->stride;
+
+    int *sharePixel = xmalloc(width * sizeof(int));  // bit "idx" is the pixel of share "idx"
+    BooleanMatrix shareRows = createBooleanMatrix(n, width);
+    shareRows.height = n;  // known at compile time in the instances
+
+    // for each row
+    for (int row = 0; row < height; row++) {
+        seekRandomPool(randomSrc, 0, firstRow + row);
+        const uint64_t *sourceRow = source->words + (size_t)row * stride;
+
+        // for each pixel
+        for (int column = 0; column < width; column++) {
+            int sourcePixel = (sourceRow[column >> 6] >> (column & 63)) & 1;
+            int subset = getRandomSubset(subsets, randomSrc);
+            int pixel = getRandomBits(randomSrc, n);
+            int wrongParity = parity(pixel & subset) ^ sourcePixel;
+            sharePixel[column] = pixel ^ (subset & -subset & -wrongParity);
         }
-        if (found != -1) {
-            shares[idx].array[i] = getPixel(source, found, i);
-        } else {
-            shares[idx].array[i] = getRandomNumber(randomSrc, 0, 2);
+
+        transposeColumnMasks(&shareRows, sharePixel);
+        for (int idx = 0; idx < n; idx++) {
+            memcpy(shares[idx].words + (size_t)row * stride, shareRows.words + idx * stride, stride * sizeof(uint64_t));
         }
     }
+
+    deleteBooleanMatrix(&shareRows);
+    xfree(sharePixel);
+}
+
+typedef void (*DistributeRandomGrids)(Image *source, Image *shares, SubsetTable *subsets, RandomPool *randomSrc,
+                                      int firstRow);
+
+// one instance of distributeRandomGridsWith() per n up to SPECIALIZED_MAX_N
+#define DISTRIBUTE_RANDOM_GRIDS(N)                                                           \
+    static void distributeRandomGrids##N(Image *source, Image *shares, SubsetTable *subsets, \
+                                         RandomPool *randomSrc, int firstRow) {              \
+        distributeRandomGridsWith(source, shares, subsets, randomSrc, firstRow, N);          \
+    }
+
+DISTRIBUTE_RANDOM_GRIDS(2)
+DISTRIBUTE_RANDOM_GRIDS(3)
+DISTRIBUTE_RANDOM_GRIDS(4)
+DISTRIBUTE_RANDOM_GRIDS(5)
+DISTRIBUTE_RANDOM_GRIDS(6)
+DISTRIBUTE_RANDOM_GRIDS(7)
+DISTRIBUTE_RANDOM_GRIDS(8)
+
+static const DistributeRandomGrids distributeRandomGridsTable[SPECIALIZED_MAX_N + 1] = {
+    NULL,
+    NULL,
+    distributeRandomGrids2,
+    distributeRandomGrids3,
+    distributeRandomGrids4,
+    distributeRandomGrids5,
+    distributeRandomGrids6,
+    distributeRandomGrids7,
+    distributeRandomGrids8,
+};
+
+void distributeRandomGrids_kn(Image *source, Image *shares, SubsetTable *subsets, RandomPool *randomSrc, int firstRow) {
+    int n = subsets->n;
+
+    if (n <= SPECIALIZED_MAX_N) {
+        distributeRandomGridsTable[n](source, shares, subsets, randomSrc, firstRow);
+    } else {
+        distributeRandomGridsWith(source, shares, subsets, randomSrc, firstRow, n);
+    }
+}
+
+typedef struct {
+    int algorithmNumber;
+    int numberOfShares;
+    SubsetTable subsets;  // only used by the (k,n) algorithms
+    RandomPool *randomSrc;
+} randomGridBandData;
+
+/*********************************************************************
+ * Function:     encryptRandomGridBand
+ *--------------------------------------------------------------------
+ * Description:  Encrypt the rows of "source", which start at row
+ *               "firstRow" of the secret image, to the shares with
+ *               the kernel of the chosen random grid algorithm.
+ ********************************************************************/
+static void encryptRandomGridBand(void *context, Image *source, Image *shares, int firstRow) {
+    randomGridBandData *data = context;
+
+    switch (data->algorithmNumber) {
+        case 1:
+            xorRandomGrids_nn(source, shares, data->randomSrc, data->numberOfShares, firstRow);
+            break;
+        case 2:
+            selectRandomGrids_2n(source, shares, data->randomSrc, data->numberOfShares, firstRow);
+            break;
+        case 3:
+            distributeRandomGrids_kn(source, shares, &data->subsets, data->randomSrc, firstRow);
+            break;
+        default:
+            break;
+    }
+}
+
+/*********************************************************************
+ * Function:     streamRandomGridAlgorithm
+ *--------------------------------------------------------------------
+ * Description:  Ask for the same input as the chosen random grid
+ *               algorithm and run its kernel band by band with
+ *               streamAlgorithm().
+ ********************************************************************/
+static void streamRandomGridAlgorithm(AlgorithmData *data) {
+    int n = data->numberOfShares;
+    randomGridBandData bandData = {
+        .algorithmNumber = data->algorithmNumber, .numberOfShares = n, .randomSrc = data->randomSrc};
+
+    if (bandData.algorithmNumber == 3 && n == 2) {
+        bandData.algorithmNumber = 1;  // the (2,2) algorithm is the (n,n) one
+    } else if (bandData.algorithmNumber == 3) {
+        int k = getKfromUser(n);
+        bandData.subsets = createSubsetTable(n, k);
+    }
+
+    streamAlgorithm(data, 1, 1, encryptRandomGridBand, &bandData);
+}
+
+void randomGrid_nn(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares) {
+    xorRandomGrids_nn(source, shares, randomSrc, numberOfShares, 0);
+}
+
+void randomGrid_2n(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares) {
+    selectRandomGrids_2n(source, shares, randomSrc, numberOfShares, 0);
+}
+
+void __randomGrid_kn(SubsetTable *subsets, Image *source, Image *shares, RandomPool *randomSrc) {
+    /*  the k temporary shares of a (k,k) random grid aren't stored: the kernel draws the k pixel
+        of each of them per pixel, right before they are spread to the shares
+    */
+    distributeRandomGrids_kn(source, shares, subsets, randomSrc, 0);
+}
+
+void randomGrid_kn(Image *source, Image *shares, RandomPool *randomSrc, int n) {
+    if (n == 2) {
+        randomGrid_nn(source, shares, randomSrc, 2);
+        return;
+    }
+
+    int k = getKfromUser(n);
+
+    SubsetTable subsets = createSubsetTable(n, k);
+    __randomGrid_kn(&subsets, source, shares, randomSrc);
 }
 
 void callRandomGridAlgorithm(AlgorithmData *data) {
@@ -38,33 +228,25 @@ void callRandomGridAlgorithm(AlgorithmData *data) {
 
     Image *source = data->source;
     Image *shares = data->shares;
-    FILE *randomSrc = data->randomSrc;
-    int arraySize = source->width * source->height;
+    RandomPool *randomSrc = data->randomSrc;
     int n = data->numberOfShares;
 
-    mallocSharesOfSourceSize(source, shares, n);
-    Pixel *storage = xmalloc(arraySize);
-    Pixel *tmpSharePixel = xmalloc(n * sizeof(Pixel));
+    if (data->sourceRows) {
+        streamRandomGridAlgorithm(data);
+        return;
+    }
+
+    mallocSharesOfSourceSize(source, shares, n, PIXEL_LAYOUT_PACKED);
 
     switch (algorithmNumber) {
         case 1:
-            randomGrid_nn(source->array, shares, &storage, randomSrc, arraySize, n);
+            randomGrid_nn(source, shares, randomSrc, n);
             break;
         case 2:
-            randomGrid_2n(source->array, shares, randomSrc, arraySize, n);
+            randomGrid_2n(source, shares, randomSrc, n);
             break;
         case 3:
-            randomGrid_kn(source, shares, &storage, randomSrc, arraySize, n);
-            break;
-
-        case 4:
-            alternate_nn_RGA(source->array, shares, tmpSharePixel, randomSrc, arraySize, n);
-            break;
-        case 5:
-            alternate_2n_RGA(source->array, shares, randomSrc, arraySize, n);
-            break;
-        case 6:
-            alternate_kn_RGA(source, shares, randomSrc, arraySize, n);
+            randomGrid_kn(source, shares, randomSrc, n);
             break;
         default:
             break;
@@ -9,25 +9,113 @@
 #include "random.h"
 #include "vcAlgorithms.h"
 
+/*  The kernels below process whole images or bands of rows of them: "firstRow" is the row of the
+    whole image, at which "source" starts. The random pool is seeked to it, so a band gets the same
+    random numbers as in the whole image.
+*/
+
+/********************************************************************
+ * Function:     xorRandomGrids_nn
+ *--------------------------------------------------------------------
+ * Description:  Word-parallel kernel of the (n,n) random grid
+ *               algorithms for bit-packed images. Chaining the (2,2)
+ *               algorithm of O. Kafri and E. Karen n-1 times results
+ *               in n-1 random grids and a last share, which is the
+ *               source XOR-ed with all of them. The grids are drawn
+ *               row by row straight into the shares and XOR-ed into
+ *               the last share, while the row is still in cache, so
+ *               the images are passed only once.
+ ********************************************************************/
+void xorRandomGrids_nn(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares, int firstRow);
+
+/********************************************************************
+ * Function:     selectRandomGrids_2n
+ *--------------------------------------------------------------------
+ * Description:  Word-parallel kernel of the (2,n) random grid
+ *               algorithms for bit-packed images. The first share is
+ *               a random grid. Every other share copies the grid,
+ *               where the source is white, and gets new random pixel,
+ *               where it is black:
+ *               share = (random AND source) OR (grid AND NOT source)
+ *               The random words are copied row by row straight from
+ *               the pool, and the select is the branch-free SIMD
+ *               kernel selectWords().
+ ********************************************************************/
+void selectRandomGrids_2n(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares, int firstRow);
+
+/********************************************************************
+ * Function:     distributeRandomGrids_kn
+ *--------------------------------------------------------------------
+ * Description:  Kernel of the (k,n) random grid algorithms for
+ *               bit-packed images. Per pixel, the (k,k) random grid
+ *               pixel are given to a random subset of k shares and
+ *               the other shares get random pixel. The k pixel are
+ *               k random bits, XOR-ed to the source pixel, which are
+ *               equally likely spread to the subset in any order. So
+ *               n random bits are drawn and the lowest bit of the
+ *               subset is flipped, if the parity of the subset bits
+ *               doesn't match the source pixel. The subset is a mask
+ *               of the table "subsets", chosen with a single bounded
+ *               draw. The n-bit pixel vectors of a row are transposed
+ *               to the rows of the shares 64 pixel at once.
+ ********************************************************************/
+void distributeRandomGrids_kn(Image *source, Image *shares, SubsetTable *subsets, RandomPool *randomSrc, int firstRow);
+
+/********************************************************************
+ * Function:     randomGrid_nn
+ *--------------------------------------------------------------------
+ * Description:  This is an implementation of a (n,n) random grid
+ *               algorithm introduced by Tzung-Her Chen and Kai-Hsiang
+ *               Tsao. It will calculate the pixel of the share images
+ *               by chaining the (2,2) random grid algorithm from
+ *               O. Kafri and E. Karen, fused to a single pass by
+ *               xorRandomGrids_nn().
+ ********************************************************************/
+void randomGrid_nn(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares);
+
+/********************************************************************
+ * Function:     randomGrid_2n
+ *--------------------------------------------------------------------
+ * Description:  This is an implementation of a (2,n) random grid
+ *               algorithm introduced by Tzung-Her Chen and Kai-Hsiang
+ *               Tsao. In contradistinction to the (n,n) algorithms,
+ *               this algorithm reveals the secret image as soon as
+ *               two of the shares are stacked together, independent
+ *               from the amount of shares existing.
+ *               It runs on the word-parallel selectRandomGrids_2n().
+ ********************************************************************/
+void randomGrid_2n(Image *source, Image *shares, RandomPool *randomSrc, int numberOfShares);
+
+/********************************************************************
+ * Function:     __randomGrid_kn
+ *--------------------------------------------------------------------
+ * Description:  This is an implementation of a (k,n) random grid
+ *               algorithm introduced by Tzung-Her Chen and Kai-Hsiang
+ *               Tsao. In contradistinction to the (n,n) algorithms,
+ *               this algorithm reveals the secret image as soon as
+ *               "k" of the shares are stacked together, independent
+ *               from the amount of shares existing.
+ *               It runs on the kernel distributeRandomGrids_kn(),
+ *               which takes k and n from the table "subsets".
+ ********************************************************************/
+void __randomGrid_kn(SubsetTable *subsets, Image *source, Image *shares, RandomPool *randomSrc);
+
 /********************************************************************
- * Function:     writePixelToShares
+ * Function:     randomGrid_kn
  *--------------------------------------------------------------------
- * Description:  If the share number is part of the first k elements
- *               of the random sorted set (of size n), the very share
- *               will get the pixel, which was calculated for one of
- *               the shares, from the source image, before.
- *               Shares with a number not contained in the first
- *               k elements will get randomly a 0/1.
+ * Description:  This is a wrapper for the (k,n) random grid algorithm
+ *               introduced by Tzung-Her Chen and Kai-Hsiang Tsao.
  ********************************************************************/
-void writePixelToShares(int *randSortedSetOfN, void *source, Image *shares, FILE *randomSrc, int n, int k, int i,
-                        Pixel (*getPixel)(void *, int, int));
+void randomGrid_kn(Image *source, Image *shares, RandomPool *randomSrc, int n);
 
 /********************************************************************
  * Function:     callRandomGridAlgorithm
  *--------------------------------------------------------------------
  * Description:  Prepares data which is needed by all, or at least
  *               multiple, random grid algorithms. It'll call the
- *               chosen algorithm with the data.
+ *               chosen algorithm with the data. If the source is read
+ *               in bands, the kernel of the chosen algorithm runs band
+ *               by band with streamAlgorithm().
  ********************************************************************/
 void callRandomGridAlgorithm(AlgorithmData *data);
 
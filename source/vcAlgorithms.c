@@ -6,15 +6,18 @@
 #include "vcAlgorithms.h"
 
 #include "fileManagement.h"
+#include "handleBMP.h"
 #include "memoryManagement.h"
 #include "menu.h"
 #include "settings.h"
+#include "simdKernels.h"
 
-void mallocSharesOfSourceSize(Image *source, Image *share, int numberOfShares) {
+void mallocSharesOfSourceSize(Image *source, Image *share, int numberOfShares, PixelLayout layout) {
     // for each share
     for (int i = 0; i < numberOfShares; i++) {
         share[i].height = source->height;
         share[i].width = source->width;
+        share[i].layout = layout;
         mallocPixelArray(&share[i]);
     }
 }
@@ -23,23 +26,89 @@ void callAlgorithm(void (*algorithm)(AlgorithmData *), int algorithmNumber) {
     int numberOfShares = getNfromUser();
 
     Image source, *shares = xmalloc(numberOfShares * sizeof(Image));
+    BmpRows sourceRows;
 
-    createSourceImage(&source);
+    if (STREAM_ROW_BANDS) {
+        source.file = xfopen(sourcePath, "rb");
+        openBmpRows(&source, &sourceRows);
+    } else {
+        createSourceImage(&source);
+    }
     deleteShareFiles();
     createShareFiles(shares, numberOfShares);
 
-    FILE *randomSrc = xfopen(RANDOM_FILE_PATH, "r");
+    RandomPool *randomSrc = createRandomPool();
 
     AlgorithmData data = {.source = &source,
                           .shares = shares,
                           .numberOfShares = numberOfShares,
-                          .algorithmNumber = RG_VERSION ? algorithmNumber + 3 : algorithmNumber,
-                          .randomSrc = randomSrc};
+                          .algorithmNumber = algorithmNumber,
+                          .randomSrc = randomSrc,
+                          .sourceRows = STREAM_ROW_BANDS ? &sourceRows : NULL};
     algorithm(&data);
 
-    drawShareFiles(shares, numberOfShares);
+    if (!data.sharesWritten) {
+        drawShareFiles(shares, numberOfShares);
+    }
+    if (data.sourceRows) {
+        closeBmpRows(data.sourceRows);
+    }
 
+    printVerbose("random source: %s\nSIMD kernels: %s\n", randomSrc->source.name, getSimdLevelName());
+
+    closeRandomPool(randomSrc);
     xcloseAll();
     xfreeAll();
     fprintf(stdout, "Success!\n");
 }
+
+void streamAlgorithm(AlgorithmData *data, int expansionHeight, int expansionWidth, EncryptBand encryptBand,
+                     void *context) {
+    Image *source = data->source;
+    Image *shares = data->shares;
+    int n = data->numberOfShares;
+    int bandHeight = STREAM_BAND_HEIGHT / expansionHeight > 1 ? STREAM_BAND_HEIGHT / expansionHeight : 1;
+    if (bandHeight > source->height) {
+        bandHeight = source->height;
+    }
+
+    // allocate the bands, which are reused for all rows of the images
+    Image sourceBand = {.width = source->width, .height = bandHeight, .layout = PIXEL_LAYOUT_PACKED};
+    mallocPixelArray(&sourceBand);
+
+    Image *shareBands = xmalloc(n * sizeof(Image));
+    for (int idx = 0; idx < n; idx++) {
+        shares[idx].width = source->width * expansionWidth;
+        shares[idx].height = source->height * expansionHeight;
+        shares[idx].layout = PIXEL_LAYOUT_PACKED;
+        startBMP(&shares[idx]);
+
+        shareBands[idx].width = shares[idx].width;
+        shareBands[idx].height = bandHeight * expansionHeight;
+        shareBands[idx].layout = PIXEL_LAYOUT_PACKED;
+        mallocPixelArray(&shareBands[idx]);
+    }
+
+    // for each band of the source
+    for (int firstRow = 0; firstRow < source->height; firstRow += bandHeight) {
+        int numRows = source->height - firstRow < bandHeight ? source->height - firstRow : bandHeight;
+        sourceBand.height = numRows;
+        readBmpRows(data->sourceRows, &sourceBand, firstRow);
+
+        for (int idx = 0; idx < n; idx++) {
+            shareBands[idx].height = numRows * expansionHeight;
+        }
+        encryptBand(context, &sourceBand, shareBands, firstRow);
+
+        for (int idx = 0; idx < n; idx++) {
+            appendBmpRows(&shares[idx], &shareBands[idx]);
+        }
+    }
+
+    for (int idx = 0; idx < n; idx++) {
+        xfree(shareBands[idx].words);
+    }
+    xfree(shareBands);
+    xfree(sourceBand.words);
+    data->sharesWritten = 1;
+}
@@ -6,16 +6,27 @@
 #ifndef VCALGORITHMS_H
 #define VCALGORITHMS_H
 
+#include "handleBMP.h"
 #include "image.h"
+#include "random.h"
+
+/*  The hot loops of the algorithms are instantiated for every number of shares up to this one, with
+    the loops over the shares unrolled. Larger numbers of shares use a generic version.
+*/
+#define SPECIALIZED_MAX_N 8
 
 typedef struct {
     Image *source;
     Image *shares;
     int numberOfShares;
     int algorithmNumber;
-    FILE *randomSrc;
+    RandomPool *randomSrc;
+    BmpRows *sourceRows;  // if STREAM_ROW_BANDS is set, "source" has no pixel and is read band by band from here
+    int sharesWritten;    // set by algorithms, which write the share files themselves
 } AlgorithmData;
 
+typedef void (*EncryptBand)(void *context, Image *source, Image *shares, int firstRow);
+
 /*********************************************************************
  * Function:     callAlgorithm
  *--------------------------------------------------------------------
@@ -24,9 +35,32 @@ typedef struct {
  *               parameter, and draw all of the share bmps, after
  *               the algorithm is finished. It'll use the settings
  *               stored in "settings.h".
+ *               If STREAM_ROW_BANDS is set, only the size of the
+ *               source is read and the algorithm has to stream it
+ *               with streamAlgorithm().
  ********************************************************************/
 void callAlgorithm(void (*algorithm)(AlgorithmData *), int algorithmNumber);
 
+/*********************************************************************
+ * Function:     streamAlgorithm
+ *--------------------------------------------------------------------
+ * Description:  Run an algorithm in bands of the source, read from
+ *               data->sourceRows, that give STREAM_BAND_HEIGHT rows
+ *               of the shares (at least one source row). Every band
+ *               is encrypted by "encryptBand" into bands of the shares,
+ *               which are appended to the share files right away. So
+ *               only one band of the source and the shares is held in
+ *               memory, independent of the image size.
+ * Input:        expansionHeight, expansionWidth = number of share
+ *               pixel per source pixel in height and width,
+ *               encryptBand = encrypts the band "source", which starts
+ *               at row "firstRow" of the whole source, to the bands
+ *               "shares",
+ *               context = data of the algorithm given to encryptBand
+ ********************************************************************/
+void streamAlgorithm(AlgorithmData *data, int expansionHeight, int expansionWidth, EncryptBand encryptBand,
+                     void *context);
+
 /*********************************************************************
  * Function:     mallocSharesOfSourceSize
  *--------------------------------------------------------------------
@@ -38,9 +72,10 @@ void callAlgorithm(void (*algorithm)(AlgorithmData *), int algorithmNumber);
  *               image,
  *               numberOfShares = amount of shares that will be
  *               created,
- * Output:       share->array will be correctly allocated for each
- *               share.
+ *               layout = PIXEL_LAYOUT_BYTE or PIXEL_LAYOUT_PACKED
+ * Output:       share->array (or share->words, if packed) will be
+ *               correctly allocated for each share.
  ********************************************************************/
-void mallocSharesOfSourceSize(Image *source, Image *share, int numberOfShares);
+void mallocSharesOfSourceSize(Image *source, Image *share, int numberOfShares, PixelLayout layout);
 
 #endif /* VCALGORITHMS_H */
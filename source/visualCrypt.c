@@ -3,12 +3,16 @@
 *   This work is licensed under the terms of the MIT license.
 */
 
+#include <errno.h>
+#include <getopt.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include "basisStore.h"
 #include "decrypt.h"
 #include "menu.h"
+#include "random.h"
 #include "settings.h"
 #include "timeMeasurement.h"
 #include "vcAlg01_deterministic.h"
@@ -17,10 +21,14 @@
 #include "vcAlgorithms.h"
 
 #define EXIT_ON_HELP 2
+#define OPTION_SEED  256  // long option without a short form
 
 // Global
 char *sourcePath = NULL;
 char *sharePath = NULL;
+uint64_t randomSeed = 0;
+int useRandomSeed = 0;
+int verbose = 0;
 
 /*********************************************************************
  * Function:     usage
@@ -34,19 +42,43 @@ static inline void usage() {
             "Options:\n"
             " -h                            display this help\n"
             " -s <source path>              set path to a secret .bmp\n"
-            " -d <destination path>         set path to a result storing directory\n\n");
+            " -d <destination path>         set path to a result storing directory\n"
+            " -v                            print details like the used SIMD kernels\n"
+            " --seed <number>               create reproducible shares, that only depend on the\n"
+            "                               seed, the image, the algorithm and n, k\n\n");
+}
+
+/*********************************************************************
+ * Function:     setRandomSeed
+ *--------------------------------------------------------------------
+ * Description:  Convert the operand of --seed to a number and store
+ *               it in the global "randomSeed".
+ * Return:       0 on success, 1 if the operand is no valid number.
+ ********************************************************************/
+static int setRandomSeed(const char *operand) {
+    char *end;
+    errno = 0;
+    unsigned long long seed = strtoull(operand, &end, 0);
+    if (errno || end == operand || *end != '\0' || *operand == '-') {
+        fprintf(stderr, "ERR: invalid seed: '%s'\n", operand);
+        return EXIT_FAILURE;
+    }
+    randomSeed = seed;
+    useRandomSeed = 1;
+    return EXIT_SUCCESS;
 }
 
 /*********************************************************************
  * Function:     getPathsFromProgramParameter
  *--------------------------------------------------------------------
- * Description:  Check the program parameters and set the global paths
- *				 according to them.
+ * Description:  Check the program parameters and set the global paths,
+ *				 the random seed and the verbose flag according to them.
  * Return:       0 on success, 1 on failure, 2 for help options.
  ********************************************************************/
 static int getPathsFromProgramParameter(int argc, char *argv[]) {
+    static const struct option longOptions[] = {{"seed", required_argument, NULL, OPTION_SEED}, {NULL, 0, NULL, 0}};
     int c = '?';
-    while ((c = getopt(argc, argv, "hs:d:")) != -1) {
+    while ((c = getopt_long(argc, argv, "hs:d:v", longOptions, NULL)) != -1) {
         switch (c) {
             case 'h':
                 usage();
@@ -57,6 +89,14 @@ static int getPathsFromProgramParameter(int argc, char *argv[]) {
             case 'd':
                 sharePath = optarg;
                 break;
+            case 'v':
+                verbose = 1;
+                break;
+            case OPTION_SEED:
+                if (setRandomSeed(optarg)) {
+                    return EXIT_FAILURE;
+                }
+                break;
             case ':':
                 fprintf(stderr, "ERR: option -%c requires an operand\n", optopt);
                 return EXIT_FAILURE;
@@ -94,6 +134,10 @@ void setPaths(char *argv[], char **logPath) {
     *logPath = xcalloc(programPathLen + strlen(TIME_LOG_PATH) + 1, 1);
     strncpy(*logPath, programPath, programPathLen);
     strncpy(*logPath + programPathLen, TIME_LOG_PATH, strlen(TIME_LOG_PATH) + 1);
+
+    basisStorePath = xcalloc(programPathLen + strlen(BASIS_STORE_PATH) + 1, 1);
+    strncpy(basisStorePath, programPath, programPathLen);
+    strncpy(basisStorePath + programPathLen, BASIS_STORE_PATH, strlen(BASIS_STORE_PATH) + 1);
 }
 
 /*********************************************************************